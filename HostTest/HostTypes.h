@@ -0,0 +1,27 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+/*
+ * The engine types that SquirrelNoise5.hpp uses, so that it can be built without the engine.
+ */
+
+using uint8 = std::uint8_t;
+using uint16 = std::uint16_t;
+using uint32 = std::uint32_t;
+using uint64 = std::uint64_t;
+using int8 = std::int8_t;
+using int16 = std::int16_t;
+using int32 = std::int32_t;
+using int64 = std::int64_t;
+
+template <typename T>
+struct TNumericLimits
+{
+	static constexpr T Min() { return std::numeric_limits<T>::min(); }
+	static constexpr T Max() { return std::numeric_limits<T>::max(); }
+	static constexpr T Lowest() { return std::numeric_limits<T>::lowest(); }
+};
\ No newline at end of file
@@ -0,0 +1,270 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "HostTypes.h"
+#include "SquirrelNoise5.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/*
+ * Builds SquirrelNoise5.hpp on its own, without the engine, and checks the raw hashes against the golden checksums of
+ * Squirrel.Benchmark. This is how those checksums are produced, and how they can be reproduced on any machine:
+ *
+ *		cmake -S HostTest -B HostTest/Build -DCMAKE_BUILD_TYPE=Release
+ *		cmake --build HostTest/Build
+ *		HostTest/Build/SquirrelHostTest [Iterations] [MaxThreads] [VerifyOnly]
+ *
+ * ctest runs it with VerifyOnly.
+ */
+namespace Squirrel::HostTest
+{
+	// Must match Squirrel::Benchmark.
+	static constexpr uint32 Seed = 1337;
+	static constexpr int32 GoldenCount = 4096;
+
+	// The checksums of the generators of Squirrel.Benchmark that are nothing but a raw hash of each position. Keep in sync.
+	namespace Golden
+	{
+		static constexpr uint64 NextUint32 = 0xDBA5229200BCC16Dull;
+		static constexpr uint64 NextReal = 0x49026D4785B0C7B6ull;
+		static constexpr uint64 NextUint64 = 0x551242C23FD9E683ull;
+		static constexpr uint64 NextReal64 = 0xE7AD0D8624F90D82ull;
+	}
+
+	// FNV-1a, over the bytes of the values, like Squirrel::Benchmark::Checksum.
+	template <typename T>
+	static uint64 Checksum(const std::vector<T>& Values)
+	{
+		const uint8* Bytes = reinterpret_cast<const uint8*>(Values.data());
+		const size_t NumBytes = Values.size() * sizeof(T);
+
+		uint64 Hash = 0xCBF29CE484222325ull;
+		for (size_t i = 0; i < NumBytes; ++i)
+		{
+			Hash ^= Bytes[i];
+			Hash *= 0x100000001B3ull;
+		}
+		return Hash;
+	}
+
+	// Check the values that Generator(Position) returns for positions 0 to GoldenCount against their golden checksum.
+	template <typename T, typename GeneratorType>
+	static bool CheckGolden(const char* Name, const uint64 Expected, GeneratorType&& Generator)
+	{
+		std::vector<T> Values(GoldenCount);
+		for (int32 i = 0; i < GoldenCount; ++i)
+		{
+			Values[i] = Generator(i);
+		}
+
+		const uint64 Actual = Checksum(Values);
+		if (Actual != Expected)
+		{
+			std::printf("  Checksum of %s is 0x%016llX, expected 0x%016llX\n", Name,
+				static_cast<unsigned long long>(Actual), static_cast<unsigned long long>(Expected));
+			std::printf("  FAILED  %s golden output\n", Name);
+			return false;
+		}
+
+		std::printf("  ok      %s golden output\n", Name);
+		return true;
+	}
+
+	// Timed loops add their results in here once they finish, so that they can't be optimized away.
+	static std::atomic<uint64> GSink = 0;
+
+	// Timed loops read their seed from here, so that the compiler can neither fold them nor reuse the result of the warm-up.
+	static volatile uint32 GTimingSeed = Seed;
+
+	// Time Body(Count, Seed), which generates Count values and returns their sum. Body is run once beforehand, to warm up
+	// the caches.
+	template <typename BodyType>
+	static void Time(const char* Name, const int32 Count, BodyType&& Body)
+	{
+		GSink.fetch_add(static_cast<uint64>(Body(Count, GTimingSeed)), std::memory_order_relaxed);
+
+		const auto Start = std::chrono::steady_clock::now();
+		GSink.fetch_add(static_cast<uint64>(Body(Count, GTimingSeed)), std::memory_order_relaxed);
+		const double Seconds = std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(), 1e-9);
+
+		std::printf("  %-48s %10.2f ns/op %10.2f M values/s\n", Name, Seconds * 1e9 / Count, Count / Seconds / 1e6);
+	}
+
+	static bool RunChecks()
+	{
+		std::printf("Checks:\n");
+
+		bool bPassed = true;
+		bPassed &= CheckGolden<uint32>("SquirrelNoise5", Golden::NextUint32,
+			[](const int32 Position) { return Raw::SquirrelNoise5(Position, Seed); });
+		bPassed &= CheckGolden<double>("Get1dNoiseZeroToOne", Golden::NextReal,
+			[](const int32 Position) { return Raw::Get1dNoiseZeroToOne(Position, Seed); });
+		bPassed &= CheckGolden<uint64>("SquirrelNoise64", Golden::NextUint64,
+			[](const int32 Position) { return Raw::SquirrelNoise64(Position, Seed); });
+		bPassed &= CheckGolden<double>("Get1dNoiseZeroToOne64", Golden::NextReal64,
+			[](const int32 Position) { return Raw::Get1dNoiseZeroToOne64(Position, Seed); });
+		return bPassed;
+	}
+
+	static void RunTimings(const int32 Num)
+	{
+		std::printf("Generators:\n");
+
+		Time("SquirrelNoise5", Num, [](const int32 Count, const uint32 LoopSeed)
+		{
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Sum += Raw::SquirrelNoise5(i, LoopSeed);
+			}
+			return Sum;
+		});
+
+		Time("Get1dNoiseZeroToOne", Num, [](const int32 Count, const uint32 LoopSeed)
+		{
+			double Sum = 0.0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Sum += Raw::Get1dNoiseZeroToOne(i, LoopSeed);
+			}
+			return Sum;
+		});
+
+		Time("Get2dNoiseUint", Num, [](const int32 Count, const uint32 LoopSeed)
+		{
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Sum += Raw::Get2dNoiseUint(i & 1023, i >> 10, LoopSeed);
+			}
+			return Sum;
+		});
+
+		Time("Get3dNoiseUint", Num, [](const int32 Count, const uint32 LoopSeed)
+		{
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Sum += Raw::Get3dNoiseUint(i & 127, (i >> 7) & 127, i >> 14, LoopSeed);
+			}
+			return Sum;
+		});
+
+		Time("SquirrelNoise64", Num, [](const int32 Count, const uint32 LoopSeed)
+		{
+			uint64 Sum = 0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Sum += Raw::SquirrelNoise64(i, LoopSeed);
+			}
+			return Sum;
+		});
+
+		Time("Get1dNoiseZeroToOne64", Num, [](const int32 Count, const uint32 LoopSeed)
+		{
+			double Sum = 0.0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Sum += Raw::Get1dNoiseZeroToOne64(i, LoopSeed);
+			}
+			return Sum;
+		});
+	}
+
+	static void RunScaling(const int32 Num, const int32 MaxThreads)
+	{
+		std::printf("Scaling (%d threads at most):\n", MaxThreads);
+
+		std::vector<int32> ThreadCounts;
+		for (int32 Threads = 1; Threads < MaxThreads; Threads *= 2)
+		{
+			ThreadCounts.push_back(Threads);
+		}
+		ThreadCounts.push_back(MaxThreads);
+
+		// The same total work is split into one range of positions per thread, so values/s should grow with the thread count.
+		for (const int32 Threads : ThreadCounts)
+		{
+			char Name[64];
+			std::snprintf(Name, sizeof(Name), "SquirrelNoise5, %d threads", Threads);
+
+			Time(Name, Num, [Threads](const int32 Count, const uint32 LoopSeed)
+			{
+				std::vector<uint32> Sums(Threads);
+				std::vector<std::thread> Workers;
+				for (int32 Job = 0; Job < Threads; ++Job)
+				{
+					Workers.emplace_back([&Sums, Count, Threads, Job, LoopSeed]
+					{
+						const int32 First = static_cast<int32>(static_cast<int64>(Count) * Job / Threads);
+						const int32 Last = static_cast<int32>(static_cast<int64>(Count) * (Job + 1) / Threads);
+
+						uint32 Sum = 0;
+						for (int32 i = First; i < Last; ++i)
+						{
+							Sum += Raw::SquirrelNoise5(i, LoopSeed);
+						}
+						Sums[Job] = Sum;
+					});
+				}
+
+				uint32 Sum = 0;
+				for (int32 Job = 0; Job < Threads; ++Job)
+				{
+					Workers[Job].join();
+					Sum += Sums[Job];
+				}
+				return Sum;
+			});
+		}
+	}
+}
+
+int main(const int ArgC, char** ArgV)
+{
+	using namespace Squirrel::HostTest;
+
+	int32 Iterations = 1 << 24;
+	int32 MaxThreads = std::max(static_cast<int32>(std::thread::hardware_concurrency()), 1);
+	bool bVerifyOnly = false;
+	int32 NumArgs = 0;
+	for (int i = 1; i < ArgC; ++i)
+	{
+		if (std::strcmp(ArgV[i], "VerifyOnly") == 0)
+		{
+			bVerifyOnly = true;
+		}
+		else if (NumArgs++ == 0)
+		{
+			Iterations = std::max(std::atoi(ArgV[i]), 1024);
+		}
+		else
+		{
+			MaxThreads = std::max(std::atoi(ArgV[i]), 1);
+		}
+	}
+
+	std::printf("SquirrelNoise5 host test: %d iterations\n", Iterations);
+
+	const bool bPassed = RunChecks();
+
+	if (!bVerifyOnly)
+	{
+		RunTimings(Iterations);
+		RunScaling(Iterations, MaxThreads);
+	}
+
+	if (bPassed)
+	{
+		std::printf("All checks passed.\n");
+		return EXIT_SUCCESS;
+	}
+
+	std::printf("Some checks failed. Existing seeds may no longer generate what they used to.\n");
+	return EXIT_FAILURE;
+}
\ No newline at end of file
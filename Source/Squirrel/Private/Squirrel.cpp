@@ -1,7 +1,11 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Squirrel.h"
-#include "SquirrelNoise5.hpp"
+#include "SquirrelNoise5Simd.h"
+#include "SquirrelShuffle.h"
+#include "SquirrelTileService.h"
+#include "Engine/NetSerialization.h"
+#include "HAL/IConsoleManager.h"
 
 /*
  *					WARNING:
@@ -16,18 +20,233 @@
 
 DEFINE_LOG_CATEGORY(LogSquirrel)
 
+static int32 GSquirrelTileCacheBudgetMB = 64;
+static FAutoConsoleVariableRef CVarSquirrelTileCacheBudgetMB(
+	TEXT("Squirrel.TileCache.BudgetMB"),
+	GSquirrelTileCacheBudgetMB,
+	TEXT("Memory budget, in megabytes, of the Squirrel subsystem's noise tile cache."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*)
+	{
+		if (GEngine)
+		{
+			if (const USquirrelSubsystem* Subsystem = GEngine->GetEngineSubsystem<USquirrelSubsystem>())
+			{
+				Subsystem->GetTileService().SetMaxCacheBytes(static_cast<SIZE_T>(FMath::Max(GSquirrelTileCacheBudgetMB, 0)) * 1024 * 1024);
+			}
+		}
+	}));
+
 #define LOCTEXT_NAMESPACE "Squirrel"
 
 namespace Squirrel
 {
-	// The master seed used to set the game world to a consistent state that can be returned to.
-	static uint32 GWorldSeed = 0;
+	// The context bound to this thread by FSquirrelContextScope. Null means the default context.
+	static thread_local FSquirrelContext* GCurrentContext = nullptr;
 
 	namespace Impl
 	{
-		constexpr uint32 SquirrelNoise5(int32& Position, const uint32 Seed)
+		// Move a position forward by Count, wrapping around the same way repeated increments would.
+		constexpr void Advance(int32& Position, const int32 Count)
+		{
+			Position = static_cast<int32>(static_cast<uint32>(Position) + static_cast<uint32>(Count));
+		}
+
+		// Fill without counting, for the Fill functions that convert the raw noise a chunk at a time.
+		static void FillRaw(FSquirrelState& State, const TArrayView<uint32> Out)
+		{
+			Simd::NoiseSequence(Out.GetData(), Out.Num(), State.Position, GetGlobalSeed());
+			Advance(State.Position, Out.Num());
+		}
+
+		// Number of values generated on the stack at a time by the Fill functions that convert the raw noise.
+		static constexpr int32 FillChunkSize = 256;
+
+		// Reads the raw noise of consecutive positions a chunk at a time, for batches whose values may each consume a
+		// variable number of positions. State is advanced by exactly the number of values read when the stream is destroyed.
+		class FRawStream
+		{
+		public:
+			FRawStream(FSquirrelState& InState, const int64 InExpected)
+			  : State(InState),
+				Position(InState.Position),
+				Seed(GetGlobalSeed()),
+				Expected(InExpected)
+			{
+			}
+
+			~FRawStream()
+			{
+				SQUIRREL_COUNT(Fill, static_cast<uint32>(Position) - static_cast<uint32>(State.Position));
+				State.Position = Position;
+			}
+
+			UE_NONCOPYABLE(FRawStream)
+
+			uint32 operator()()
+			{
+				if (Index == Num)
+				{
+					// Only generate as much as is still expected to be read, so that short batches stay cheap.
+					Num = static_cast<int32>(FMath::Clamp<int64>(Expected, 1, FillChunkSize));
+					Simd::NoiseSequence(Buffer, Num, Position, Seed);
+					Index = 0;
+				}
+
+				--Expected;
+				Advance(Position, 1);
+				return Buffer[Index++];
+			}
+
+		private:
+			FSquirrelState& State;
+			int32 Position;
+			const uint32 Seed;
+			int64 Expected;
+			int32 Index = 0;
+			int32 Num = 0;
+			uint32 Buffer[FillChunkSize];
+		};
+
+		// Set bit (i % 32) of Mask[i / 32] for each of Num rolls, where Test(i, Noise) rolls i against its raw noise.
+		template <typename TestType>
+		void FillRolls(FSquirrelState& State, const int32 Num, const TArrayView<uint32> Mask, TestType&& Test)
+		{
+			check(Num >= 0 && Mask.Num() >= FMath::DivideAndRoundUp(Num, 32));
+			SQUIRREL_TRACE_BATCH(FillRolls, Num);
+			SQUIRREL_COUNT(Fill, Num);
+
+			// A multiple of 32, so that every chunk starts on a word of its own.
+			static_assert(FillChunkSize % 32 == 0);
+			uint32 Noise[FillChunkSize];
+
+			for (int32 Offset = 0; Offset < Num; Offset += FillChunkSize)
+			{
+				const int32 Count = FMath::Min(FillChunkSize, Num - Offset);
+				FillRaw(State, MakeArrayView(Noise, Count));
+
+				for (int32 Word = 0; Word * 32 < Count; ++Word)
+				{
+					const int32 Bits = FMath::Min(32, Count - Word * 32);
+					uint32 Value = 0;
+					for (int32 Bit = 0; Bit < Bits; ++Bit)
+					{
+						Value |= static_cast<uint32>(Test(Offset + Word * 32 + Bit, Noise[Word * 32 + Bit])) << Bit;
+					}
+					Mask[(Offset >> 5) + Word] = Value;
+				}
+			}
+		}
+
+		// Round Value down, then add one if Noise is below the fraction that was rounded off.
+		static double RoundStochastic(const double Value, const uint32 Noise)
+		{
+			const double Whole = FMath::FloorToDouble(Value);
+			return Whole + static_cast<double>(V2::FChance::FromProbability(Value - Whole).Test(Noise));
+		}
+
+		// The high 64 bits of the 128-bit product of A and B, with the low 64 bits written to Low.
+		constexpr uint64 MultiplyHigh64(const uint64 A, const uint64 B, uint64& Low)
+		{
+			const uint64 ALow = A & 0xFFFFFFFF;
+			const uint64 AHigh = A >> 32;
+			const uint64 BLow = B & 0xFFFFFFFF;
+			const uint64 BHigh = B >> 32;
+
+			const uint64 LowLow = ALow * BLow;
+			const uint64 HighLow = AHigh * BLow;
+			const uint64 LowHigh = ALow * BHigh;
+			const uint64 HighHigh = AHigh * BHigh;
+
+			// Cannot overflow: at most (2^32 - 1) * 2 + (2^32 - 1)^2 = 2^64 - 1.
+			const uint64 Cross = (LowLow >> 32) + (HighLow & 0xFFFFFFFF) + LowHigh;
+			Low = (Cross << 32) | (LowLow & 0xFFFFFFFF);
+			return HighHigh + (HighLow >> 32) + (Cross >> 32);
+		}
+
+		// Reduce raw 32-bit noise into [0, Range) by multiply-shift (Lemire, "Fast Random Integer Generation in an Interval").
+		// Range must not be 0.
+		template <typename DrawType>
+		uint32 Bounded32(DrawType& Draw, const uint32 Range, const V2::EBoundedMode Mode)
+		{
+			uint64 Product = static_cast<uint64>(Draw()) * Range;
+			uint32 Low = static_cast<uint32>(Product);
+
+			// The low half can only fall in the biased zone if it is below Range, so the modulo is rarely ever computed.
+			if (Mode == V2::EBoundedMode::Unbiased && Low < Range)
+			{
+				const uint32 Threshold = (0u - Range) % Range;
+				while (Low < Threshold)
+				{
+					Product = static_cast<uint64>(Draw()) * Range;
+					Low = static_cast<uint32>(Product);
+				}
+			}
+
+			return static_cast<uint32>(Product >> 32);
+		}
+
+		// Two consecutive positions combined into 64 bits, the first being the high half. Draws of 64-bit streams are used as-is.
+		template <typename DrawType>
+		uint64 Draw64(DrawType& Draw)
+		{
+			if constexpr (sizeof(decltype(Draw())) == sizeof(uint64))
+			{
+				return Draw();
+			}
+			else
+			{
+				const uint64 High = Draw();
+				return (High << 32) | Draw();
+			}
+		}
+
+		// 64-bit version of Bounded32. Range must not be 0.
+		template <typename DrawType>
+		uint64 Bounded64(DrawType& Draw, const uint64 Range, const V2::EBoundedMode Mode)
+		{
+			uint64 Low;
+			uint64 High = MultiplyHigh64(Draw64(Draw), Range, Low);
+
+			if (Mode == V2::EBoundedMode::Unbiased && Low < Range)
+			{
+				const uint64 Threshold = (0ull - Range) % Range;
+				while (Low < Threshold)
+				{
+					High = MultiplyHigh64(Draw64(Draw), Range, Low);
+				}
+			}
+
+			return High;
+		}
+
+		template <typename DrawType>
+		int32 Int32InRange(DrawType& Draw, const int32 Min, const int32 Max, const V2::EBoundedMode Mode)
 		{
-			return ::SquirrelNoise5(Position++, Seed);
+			if (Max < Min)
+			{
+				Draw();
+				return Min;
+			}
+
+			// Wraps to 0 when the range covers all of int32.
+			const uint32 Range = static_cast<uint32>(Max) - static_cast<uint32>(Min) + 1;
+			const uint32 Offset = Range != 0 ? Bounded32(Draw, Range, Mode) : Draw();
+			return static_cast<int32>(static_cast<uint32>(Min) + Offset);
+		}
+
+		template <typename DrawType>
+		int64 Int64InRange(DrawType& Draw, const int64 Min, const int64 Max, const V2::EBoundedMode Mode)
+		{
+			if (Max < Min)
+			{
+				Draw64(Draw);
+				return Min;
+			}
+
+			// Wraps to 0 when the range covers all of int64.
+			const uint64 Range = static_cast<uint64>(Max) - static_cast<uint64>(Min) + 1;
+			const uint64 Offset = Range != 0 ? Bounded64(Draw, Range, Mode) : Draw64(Draw);
+			return static_cast<int64>(static_cast<uint64>(Min) + Offset);
 		}
 	}
 
@@ -74,20 +293,32 @@ namespace Squirrel
 
 	uint32 GetGlobalSeed()
 	{
-		return GWorldSeed;
+		return GetCurrentContext().GetSeed();
 	}
 
 	void SetGlobalSeed(const uint32 Seed)
 	{
-		GWorldSeed = Seed;
+		GetCurrentContext().SetSeed(Seed);
+	}
+
+	FSquirrelContext& GetDefaultContext()
+	{
+		// The master seed used to set the game world to a consistent state that can be returned to.
+		static FSquirrelContext DefaultContext;
+		return DefaultContext;
 	}
 
-	constexpr int32 NextInt32(FSquirrelState& State, const int32 Max)
+	FSquirrelContext& GetCurrentContext()
+	{
+		return GCurrentContext ? *GCurrentContext : GetDefaultContext();
+	}
+
+	int32 NextInt32(FSquirrelState& State, const int32 Max)
 	{
 		return Max > 0 ? FMath::Min(FMath::TruncToInt(NextReal(State) * static_cast<double>(Max)), Max - 1) : 0;
 	}
 
-	constexpr int32 NextInt32InRange(FSquirrelState& State, const int32 Min, const int32 Max)
+	int32 NextInt32InRange(FSquirrelState& State, const int32 Min, const int32 Max)
     {
 		// @todo Min and Max must only cover *half* the int32 range, or it will cause an overflow in (Max - Min)
 		// look into alternate ways to generate random values that don't have this limit
@@ -96,12 +327,13 @@ namespace Squirrel
 		return Min + NextInt32(State, Range);
     }
 
-	constexpr double NextReal(FSquirrelState& State)
+	double NextReal(FSquirrelState& State)
 	{
-		return Get1dNoiseZeroToOne(State.Position++, GWorldSeed);
+		SQUIRREL_COUNT(Next, 1);
+		return Raw::Get1dNoiseZeroToOne(State.Position++, GetGlobalSeed());
 	}
 
-	constexpr double NextRealInRange(FSquirrelState& State, const double Min, const double Max)
+	double NextRealInRange(FSquirrelState& State, const double Min, const double Max)
 	{
 		// @todo Min and Max must only cover *half* the double range, or it will cause an overflow in (Max - Min)
 		// look into alternate ways to generate random values that don't have this limit
@@ -109,7 +341,7 @@ namespace Squirrel
 		return Min + (Max - Min) * NextReal(State);
 	}
 
-	constexpr bool RollChance(FSquirrelState& State, double& Roll, const double Chance, const double RollModifier)
+	bool RollChance(FSquirrelState& State, double& Roll, const double Chance, const double RollModifier)
 	{
 		if (ensure((Chance >= 0.0) && (Chance <= 100.0)) ||
 			ensure((RollModifier >= -100.0) && (RollModifier <= 100.0)))
@@ -122,7 +354,7 @@ namespace Squirrel
 		return Roll >= Chance;
 	}
 
-	constexpr int32 RoundWithWeightByFraction(FSquirrelState& State, const double Value)
+	int32 RoundWithWeightByFraction(FSquirrelState& State, const double Value)
 	{
 		const double Whole = Math::SqFloor(Value);
 		const double Remainder = Value - Whole;
@@ -136,6 +368,421 @@ namespace Squirrel
 		// Otherwise, return the whole number plus the random weighted bool.
 		return Whole + (Remainder >= NextReal(State));
 	}
+
+	void Fill(FSquirrelState& State, const TArrayView<uint32> Out)
+	{
+		SQUIRREL_TRACE_BATCH(Fill, Out.Num());
+		SQUIRREL_COUNT(Fill, Out.Num());
+		Impl::FillRaw(State, Out);
+	}
+
+	void Fill(FSquirrelState& State, const TArrayView<double> Out)
+	{
+		SQUIRREL_TRACE_BATCH(Fill, Out.Num());
+		SQUIRREL_COUNT(Fill, Out.Num());
+
+		uint32 Noise[Impl::FillChunkSize];
+
+		for (int32 Offset = 0; Offset < Out.Num(); Offset += Impl::FillChunkSize)
+		{
+			const int32 Count = FMath::Min(Impl::FillChunkSize, Out.Num() - Offset);
+			Impl::FillRaw(State, MakeArrayView(Noise, Count));
+
+			double* Dest = Out.GetData() + Offset;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Dest[i] = Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise[i]);
+			}
+		}
+	}
+
+	void Fill(FSquirrelState& State, const TArrayView<float> Out)
+	{
+		SQUIRREL_TRACE_BATCH(Fill, Out.Num());
+		SQUIRREL_COUNT(Fill, Out.Num());
+
+		uint32 Noise[Impl::FillChunkSize];
+
+		for (int32 Offset = 0; Offset < Out.Num(); Offset += Impl::FillChunkSize)
+		{
+			const int32 Count = FMath::Min(Impl::FillChunkSize, Out.Num() - Offset);
+			Impl::FillRaw(State, MakeArrayView(Noise, Count));
+
+			float* Dest = Out.GetData() + Offset;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Dest[i] = static_cast<float>(Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise[i]));
+			}
+		}
+	}
+
+	void NextEach(const TArrayView<int32> Positions, const TConstArrayView<uint32> Seeds, const TArrayView<uint32> Out)
+	{
+		check(Seeds.Num() == Positions.Num() && Out.Num() == Positions.Num());
+		SQUIRREL_COUNT(Fill, Out.Num());
+
+		Simd::NoiseGather(Out.GetData(), Positions.GetData(), Seeds.GetData(), Out.Num());
+		for (int32& Position : Positions)
+		{
+			Impl::Advance(Position, 1);
+		}
+	}
+
+	FSquirrelState Split(const FSquirrelState& Parent, const int32 Index)
+	{
+		// Hashing the index under a seed derived from the parent, rather than offsetting the parent's position, keeps
+		// neighbouring children from walking over each other's positions.
+		return FSquirrelState{ static_cast<int32>(Raw::Get1dNoiseUint(Index, HashCombine(Parent.Position, GetGlobalSeed()))) };
+	}
+
+	void Split(const FSquirrelState& Parent, const TArrayView<FSquirrelState> Children)
+	{
+		const uint32 ChildSeed = HashCombine(Parent.Position, GetGlobalSeed());
+
+		for (int32 i = 0; i < Children.Num(); ++i)
+		{
+			Children[i].Position = static_cast<int32>(Raw::Get1dNoiseUint(i, ChildSeed));
+		}
+	}
+
+	uint32 SplitSeed(const uint32 Seed, const int32 Index)
+	{
+		// Salted, so that children don't coincide with the per-octave or per-node seeds, which are Get1dNoiseUint(N, Seed).
+		static constexpr int32 SplitSalt = 0x5B117;
+		return Raw::Get1dNoiseUint(Index, HashCombine(SplitSalt, Seed));
+	}
+
+	namespace V2
+	{
+		int32 NextInt32(FSquirrelState& State, const int32 Max, const EBoundedMode Mode)
+		{
+			auto Draw = [&State] { return Next<uint32>(State); };
+
+			if (Max <= 0)
+			{
+				Draw();
+				return 0;
+			}
+
+			return static_cast<int32>(Impl::Bounded32(Draw, static_cast<uint32>(Max), Mode));
+		}
+
+		int32 NextInt32InRange(FSquirrelState& State, const int32 Min, const int32 Max, const EBoundedMode Mode)
+		{
+			auto Draw = [&State] { return Next<uint32>(State); };
+			return Impl::Int32InRange(Draw, Min, Max, Mode);
+		}
+
+		int64 NextInt64InRange(FSquirrelState& State, const int64 Min, const int64 Max, const EBoundedMode Mode)
+		{
+			auto Draw = [&State] { return Next<uint32>(State); };
+			return Impl::Int64InRange(Draw, Min, Max, Mode);
+		}
+
+		void FillInt32InRange(FSquirrelState& State, const int32 Min, const int32 Max, const TArrayView<int32> Out, const EBoundedMode Mode)
+		{
+			SQUIRREL_TRACE_BATCH(FillInt32InRange, Out.Num());
+			Impl::FRawStream Draw(State, Out.Num());
+
+			for (int32& Value : Out)
+			{
+				Value = Impl::Int32InRange(Draw, Min, Max, Mode);
+			}
+		}
+
+		void FillInt64InRange(FSquirrelState& State, const int64 Min, const int64 Max, const TArrayView<int64> Out, const EBoundedMode Mode)
+		{
+			SQUIRREL_TRACE_BATCH(FillInt64InRange, Out.Num());
+			Impl::FRawStream Draw(State, static_cast<int64>(Out.Num()) * 2);
+
+			for (int64& Value : Out)
+			{
+				Value = Impl::Int64InRange(Draw, Min, Max, Mode);
+			}
+		}
+
+		bool Roll(FSquirrelState& State, const FChance Chance)
+		{
+			return Chance.Test(Next<uint32>(State));
+		}
+
+		void FillRolls(FSquirrelState& State, const FChance Chance, const int32 Num, const TArrayView<uint32> OutMask)
+		{
+			Impl::FillRolls(State, Num, OutMask, [Chance](int32, const uint32 Noise) { return Chance.Test(Noise); });
+		}
+
+		void FillRolls(FSquirrelState& State, const TConstArrayView<FChance> Chances, const TArrayView<uint32> OutMask)
+		{
+			Impl::FillRolls(State, Chances.Num(), OutMask, [&Chances](const int32 Index, const uint32 Noise) { return Chances[Index].Test(Noise); });
+		}
+
+		double RoundStochastic(FSquirrelState& State, const double Value)
+		{
+			return Impl::RoundStochastic(Value, Next<uint32>(State));
+		}
+
+		void RoundStochastic(FSquirrelState& State, const TArrayView<double> Values)
+		{
+			SQUIRREL_TRACE_BATCH(RoundStochastic, Values.Num());
+			SQUIRREL_COUNT(Fill, Values.Num());
+
+			uint32 Noise[Impl::FillChunkSize];
+
+			for (int32 Offset = 0; Offset < Values.Num(); Offset += Impl::FillChunkSize)
+			{
+				const int32 Count = FMath::Min(Impl::FillChunkSize, Values.Num() - Offset);
+				Impl::FillRaw(State, MakeArrayView(Noise, Count));
+
+				double* Dest = Values.GetData() + Offset;
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = Impl::RoundStochastic(Dest[i], Noise[i]);
+				}
+			}
+		}
+
+		void RoundStochastic(FSquirrelState& State, const TArrayView<float> Values)
+		{
+			SQUIRREL_TRACE_BATCH(RoundStochastic, Values.Num());
+			SQUIRREL_COUNT(Fill, Values.Num());
+
+			uint32 Noise[Impl::FillChunkSize];
+
+			for (int32 Offset = 0; Offset < Values.Num(); Offset += Impl::FillChunkSize)
+			{
+				const int32 Count = FMath::Min(Impl::FillChunkSize, Values.Num() - Offset);
+				Impl::FillRaw(State, MakeArrayView(Noise, Count));
+
+				float* Dest = Values.GetData() + Offset;
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = static_cast<float>(Impl::RoundStochastic(Dest[i], Noise[i]));
+				}
+			}
+		}
+	}
+
+	double NextReal(FSquirrelState64& State)
+	{
+		return Raw::Noise64ToZeroToOne(Next<uint64>(State));
+	}
+
+	double NextRealInRange(FSquirrelState64& State, const double Min, const double Max)
+	{
+		return Min + (Max - Min) * NextReal(State);
+	}
+
+	int32 NextInt32InRange(FSquirrelState64& State, const int32 Min, const int32 Max, const V2::EBoundedMode Mode)
+	{
+		// Reduced as 64-bit, so that each value is still a single draw.
+		return static_cast<int32>(NextInt64InRange(State, Min, Max, Mode));
+	}
+
+	int64 NextInt64InRange(FSquirrelState64& State, const int64 Min, const int64 Max, const V2::EBoundedMode Mode)
+	{
+		auto Draw = [&State] { return Next<uint64>(State); };
+		return Impl::Int64InRange(Draw, Min, Max, Mode);
+	}
+
+	void Fill(FSquirrelState64& State, const TArrayView<uint64> Out)
+	{
+		SQUIRREL_TRACE_BATCH(Fill, Out.Num());
+		SQUIRREL_COUNT(Fill, Out.Num());
+
+		// There is no SIMD kernel, since SSE and AVX2 have no 64-bit multiply. Keeping the position and seed in registers
+		// still lets the compiler interleave the hashes of consecutive positions.
+		int64 Position = State.Position;
+		const uint64 Seed = GetGlobalSeed();
+		for (uint64& Value : Out)
+		{
+			Value = Raw::SquirrelNoise64(Position++, Seed);
+		}
+		State.Position = Position;
+	}
+
+	void Fill(FSquirrelState64& State, const TArrayView<double> Out)
+	{
+		SQUIRREL_TRACE_BATCH(Fill, Out.Num());
+		SQUIRREL_COUNT(Fill, Out.Num());
+
+		int64 Position = State.Position;
+		const uint64 Seed = GetGlobalSeed();
+		for (double& Value : Out)
+		{
+			Value = Raw::Get1dNoiseZeroToOne64(Position++, Seed);
+		}
+		State.Position = Position;
+	}
+
+	void FillInt64InRange(FSquirrelState64& State, const int64 Min, const int64 Max, const TArrayView<int64> Out, const V2::EBoundedMode Mode)
+	{
+		SQUIRREL_TRACE_BATCH(FillInt64InRange, Out.Num());
+
+		int64 Position = State.Position;
+		const uint64 Seed = GetGlobalSeed();
+		auto Draw = [&Position, Seed] { return Raw::SquirrelNoise64(Position++, Seed); };
+
+		for (int64& Value : Out)
+		{
+			Value = Impl::Int64InRange(Draw, Min, Max, Mode);
+		}
+
+		SQUIRREL_COUNT(Fill, static_cast<uint32>(Position - State.Position));
+		State.Position = Position;
+	}
+}
+
+namespace Squirrel::Net
+{
+	// What a state was last sent as, per connection. The engine rolls it back to the one sent with the lost packet when a
+	// packet is lost, so deltas are always written against a value that the receiver has, or will skip (see ReadPosition).
+	class FStateDeltaBase : public INetDeltaBaseState
+	{
+	public:
+		FStateDeltaBase(const uint32 InSeed, const int32 InPosition)
+		  : Seed(InSeed),
+			Position(InPosition)
+		{
+		}
+
+		virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+		{
+			const FStateDeltaBase* Other = static_cast<const FStateDeltaBase*>(OtherState);
+			return Seed == Other->Seed && Position == Other->Position;
+		}
+
+		const uint32 Seed;
+		const int32 Position;
+	};
+
+	// Write Position as the zigzag varint of its difference from Base, one byte per 7 bits, so that a stream that has
+	// advanced by fewer than 64 draws costs 16 bits. The low byte of the base goes first, so that a receiver can tell when
+	// it doesn't have that base.
+	static void WritePosition(FBitWriter& Writer, const int32 Base, int32 Position)
+	{
+		uint8 Tag = static_cast<uint8>(Base);
+		const int32 Delta = static_cast<int32>(static_cast<uint32>(Position) - static_cast<uint32>(Base));
+		uint32 Zigzag = (static_cast<uint32>(Delta) << 1) ^ static_cast<uint32>(Delta >> 31);
+
+		Writer << Tag;
+		Writer.SerializeIntPacked(Zigzag);
+	}
+
+	/**
+	 * Read a position written by WritePosition, against the position the receiver has. Returns false, leaving Position
+	 * unchanged, if the delta was written against a base from a packet that was lost. Packets after a lost one are skipped
+	 * like this until the sender learns of the loss, rolls its base back, and sends the delta again.
+	 */
+	static bool ReadPosition(FBitReader& Reader, int32& Position)
+	{
+		uint8 Tag = 0;
+		uint32 Zigzag = 0;
+		Reader << Tag;
+		Reader.SerializeIntPacked(Zigzag);
+
+		if (Reader.IsError() || Tag != static_cast<uint8>(Position))
+		{
+			return false;
+		}
+
+		const int32 Delta = static_cast<int32>((Zigzag >> 1) ^ (0 - (Zigzag & 1)));
+		Position = static_cast<int32>(static_cast<uint32>(Position) + static_cast<uint32>(Delta));
+		return true;
+	}
+
+	// Shared by FSquirrelState, whose seed is always 0, and FSquirrelWorldState.
+	static bool DeltaSerialize(FNetDeltaSerializeInfo& DeltaParms, uint32& Seed, int32& Position)
+	{
+		if (FBitWriter* Writer = DeltaParms.Writer)
+		{
+			const FStateDeltaBase* Base = static_cast<const FStateDeltaBase*>(DeltaParms.OldState);
+			if (Base && Base->Seed == Seed && Base->Position == Position)
+			{
+				return false;
+			}
+
+			uint8 bDelta = Base != nullptr;
+			Writer->SerializeBits(&bDelta, 1);
+
+			if (bDelta)
+			{
+				uint8 bSeedChanged = Base->Seed != Seed;
+				Writer->SerializeBits(&bSeedChanged, 1);
+				if (bSeedChanged)
+				{
+					*Writer << Seed;
+				}
+				WritePosition(*Writer, Base->Position, Position);
+			}
+			else
+			{
+				*Writer << Seed;
+				*Writer << Position;
+			}
+
+			*DeltaParms.NewState = MakeShared<FStateDeltaBase>(Seed, Position);
+			return true;
+		}
+
+		if (FBitReader* Reader = DeltaParms.Reader)
+		{
+			uint8 bDelta = 0;
+			Reader->SerializeBits(&bDelta, 1);
+
+			if (bDelta)
+			{
+				uint8 bSeedChanged = 0;
+				uint32 NewSeed = Seed;
+				Reader->SerializeBits(&bSeedChanged, 1);
+				if (bSeedChanged)
+				{
+					*Reader << NewSeed;
+				}
+
+				// The seed is only applied along with the position, so that the receiver always has a state that was sent.
+				int32 NewPosition = Position;
+				if (ReadPosition(*Reader, NewPosition))
+				{
+					Seed = NewSeed;
+					Position = NewPosition;
+				}
+			}
+			else
+			{
+				*Reader << Seed;
+				*Reader << Position;
+			}
+
+			return !Reader->IsError();
+		}
+
+		return false;
+	}
+}
+
+bool FSquirrelState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Position;
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+bool FSquirrelState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	uint32 Seed = 0;
+	return Squirrel::Net::DeltaSerialize(DeltaParms, Seed, Position);
+}
+
+bool FSquirrelWorldState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << GlobalSeed;
+	return RuntimeState.NetSerialize(Ar, Map, bOutSuccess);
+}
+
+bool FSquirrelWorldState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	return Squirrel::Net::DeltaSerialize(DeltaParms, GlobalSeed, RuntimeState.Position);
 }
 
 #if WITH_EDITOR
@@ -147,6 +794,45 @@ void FSquirrelState::RandomizeState()
 }
 #endif
 
+FSquirrelContext::FSquirrelContext(const uint32 InSeed, const int32 InRuntimePosition)
+  : Seed(InSeed),
+	RuntimePosition(InRuntimePosition)
+{
+}
+
+int32 FSquirrelContext::NewPosition()
+{
+	// Equivalent to Squirrel::Next<int32>, except that the position is claimed with a single atomic increment.
+	SQUIRREL_COUNT(NewPosition, 1);
+	const int32 Position = RuntimePosition.fetch_add(1, std::memory_order_relaxed);
+	return static_cast<int32>(Squirrel::Raw::SquirrelNoise5(Position, GetSeed()));
+}
+
+FSquirrelWorldState FSquirrelContext::SaveState() const
+{
+	return FSquirrelWorldState{GetSeed(), FSquirrelState{ RuntimePosition.load(std::memory_order_relaxed) } };
+}
+
+void FSquirrelContext::LoadState(const FSquirrelWorldState& State)
+{
+	SetSeed(State.GlobalSeed);
+	RuntimePosition.store(State.RuntimeState.Position, std::memory_order_relaxed);
+}
+
+FSquirrelContextScope::FSquirrelContextScope(FSquirrelContext* Context)
+  : Previous(Squirrel::GCurrentContext)
+{
+	if (Context)
+	{
+		Squirrel::GCurrentContext = Context;
+	}
+}
+
+FSquirrelContextScope::~FSquirrelContextScope()
+{
+	Squirrel::GCurrentContext = Previous;
+}
+
 USquirrel::USquirrel()
 {
 }
@@ -159,13 +845,12 @@ void USquirrel::PostInitProperties()
 	{
 		if (const UWorld* World = GEngine->GetWorldFromContextObject(GetTypedOuter<AActor>(), EGetWorldErrorMode::ReturnNull))
 		{
+			WorldSubsystem = World->GetSubsystem<USquirrelWorldSubsystem>();
+
 			// At runtime, Squirrels should be given random (but still seeded) positions
 			if (World->HasBegunPlay())
 			{
-				if (USquirrelSubsystem* Subsystem = GEngine->GetEngineSubsystem<USquirrelSubsystem>())
-				{
-					State.Position = Subsystem->NewPosition();
-				}
+				State.Position = GetContext().NewPosition();
 			}
 #if WITH_EDITOR
 			// In the editor, they should be given a new one in any-case
@@ -178,6 +863,18 @@ void USquirrel::PostInitProperties()
 	}
 }
 
+FSquirrelContext& USquirrel::GetContext() const
+{
+	if (const USquirrelWorldSubsystem* Subsystem = WorldSubsystem.Get())
+	{
+		if (Subsystem->HasIsolatedContext())
+		{
+			return Subsystem->GetContext();
+		}
+	}
+	return Squirrel::GetCurrentContext();
+}
+
 void USquirrel::Jump(const int32 NewPosition)
 {
 	State.Position = NewPosition;
@@ -190,80 +887,136 @@ int32 USquirrel::GetPosition() const
 
 int32 USquirrel::NextInt32(const int32 Max)
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::NextInt32(State, Max);
 }
 
 int32 USquirrel::NextInt32InRange(const int32 Min, const int32 Max)
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::NextInt32InRange(State, Min, Max);
 }
 
 bool USquirrel::NextBool()
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::Next<bool>(State);
 }
 
 double USquirrel::NextReal()
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::NextReal(State);
 }
 
 double USquirrel::NextRealInRange(const double Min, const double Max)
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::NextRealInRange(State, Min, Max);
 }
 
 bool USquirrel::RollChance(double& Roll, const double Chance, const double RollModifier)
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::RollChance(State, Roll, Chance, RollModifier);
 }
 
 int32 USquirrel::RoundWithWeightByFraction(const double Value)
 {
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
 	return Squirrel::RoundWithWeightByFraction(State, Value);
 }
 
+void USquirrel::SampleWithoutReplacement(const int32 N, const int32 K, TArray<int32>& OutIndices)
+{
+	FSquirrelContextScope Scope(GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*this);
+	Squirrel::SampleWithoutReplacement(State, N, K, OutIndices);
+}
+
 void USquirrelSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
+	TileService = MakeShared<FSquirrelTileService>(static_cast<SIZE_T>(FMath::Max(GSquirrelTileCacheBudgetMB, 0)) * 1024 * 1024);
+
 #if WITH_EDITOR
 	if (GIsEditor)
 	{
-		RuntimePositionsSquirrel.RandomizeState();
+		FSquirrelState Randomized;
+		Randomized.RandomizeState();
+		Squirrel::GetDefaultContext().LoadState(FSquirrelWorldState{Squirrel::GetDefaultContext().GetSeed(), Randomized });
 	}
 #endif
 }
 
 void USquirrelSubsystem::Deinitialize()
 {
+	TileService.Reset();
+
 	Super::Deinitialize();
 }
 
 int32 USquirrelSubsystem::NewPosition()
 {
-	return Squirrel::Next<int32>(RuntimePositionsSquirrel);
+	return Squirrel::GetDefaultContext().NewPosition();
 }
 
 int64 USquirrelSubsystem::GetGlobalSeed() const
 {
-	return Squirrel::GetGlobalSeed();
+	return Squirrel::GetDefaultContext().GetSeed();
 }
 
 void USquirrelSubsystem::SetGlobalSeed(const int64 NewSeed)
 {
-	Squirrel::SetGlobalSeed(NewSeed);
+	Squirrel::GetDefaultContext().SetSeed(NewSeed);
 }
 
 FSquirrelWorldState USquirrelSubsystem::SaveWorldState() const
 {
-	return FSquirrelWorldState{Squirrel::GetGlobalSeed(), RuntimePositionsSquirrel };
+	return Squirrel::GetDefaultContext().SaveState();
 }
 
 void USquirrelSubsystem::LoadGameState(const FSquirrelWorldState State)
 {
-	Squirrel::SetGlobalSeed(State.GlobalSeed);
-	RuntimePositionsSquirrel = State.RuntimeState;
+	Squirrel::GetDefaultContext().LoadState(State);
+}
+
+void USquirrelWorldSubsystem::IsolateContext(const int64 Seed)
+{
+	IsolatedContext = MakeShared<FSquirrelContext, ESPMode::ThreadSafe>(static_cast<uint32>(Seed));
+}
+
+int64 USquirrelWorldSubsystem::GetSeed() const
+{
+	return GetContext().GetSeed();
+}
+
+void USquirrelWorldSubsystem::SetSeed(const int64 NewSeed)
+{
+	GetContext().SetSeed(NewSeed);
+}
+
+FSquirrelWorldState USquirrelWorldSubsystem::SaveWorldState() const
+{
+	return GetContext().SaveState();
+}
+
+void USquirrelWorldSubsystem::LoadWorldState(const FSquirrelWorldState State)
+{
+	GetContext().LoadState(State);
+}
+
+FSquirrelContext& USquirrelWorldSubsystem::GetContext() const
+{
+	return IsolatedContext.IsValid() ? *IsolatedContext : Squirrel::GetDefaultContext();
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
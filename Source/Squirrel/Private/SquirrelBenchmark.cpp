@@ -0,0 +1,1298 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelBenchmark.h"
+#include "Squirrel.h"
+#include "SquirrelCellularNoise.h"
+#include "SquirrelCoherentNoise.h"
+#include "SquirrelDistributions.h"
+#include "SquirrelGeometry.h"
+#include "SquirrelGrid.h"
+#include "SquirrelLowDiscrepancy.h"
+#include "SquirrelNoise5.hpp"
+#include "SquirrelNoise5Simd.h"
+#include "SquirrelNoiseGraph.h"
+#include "SquirrelParallel.h"
+#include "SquirrelRng.h"
+#include "SquirrelScatter.h"
+#include "SquirrelShuffle.h"
+#include "SquirrelStateRegistry.h"
+#include "SquirrelWeightedTable.h"
+#include "Async/ParallelFor.h"
+#include "Engine/NetSerialization.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+
+static FAutoConsoleCommand CmdSquirrelBenchmark(
+	TEXT("Squirrel.Benchmark"),
+	TEXT("Check every Squirrel generator against its golden output, then time it. Usage: Squirrel.Benchmark [Iterations] [MaxThreads] [VerifyOnly]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		Squirrel::Benchmark::FOptions Options;
+		if (Args.IsValidIndex(0))
+		{
+			LexFromString(Options.Iterations, *Args[0]);
+		}
+		if (Args.IsValidIndex(1))
+		{
+			LexFromString(Options.MaxThreads, *Args[1]);
+		}
+		Options.bVerifyOnly = Args.Contains(TEXT("VerifyOnly"));
+
+		Squirrel::Benchmark::Run(Options);
+	}));
+
+namespace Squirrel::Benchmark
+{
+	// Everything generates from this seed, in a context of its own, so the game's seed is left untouched.
+	static constexpr uint32 Seed = 1337;
+
+	// Number of values the golden checksums cover, starting at position 0.
+	static constexpr int32 GoldenCount = 4096;
+
+	// FNV-1a checksums of the output of the scalar reference of each generator, for Seed. If one of these fails, existing
+	// seeds no longer generate what they used to.
+	namespace Golden
+	{
+		static constexpr uint64 NextUint32 = 0xDBA5229200BCC16Dull;
+		static constexpr uint64 NextReal = 0x49026D4785B0C7B6ull;
+		static constexpr uint64 NextInt32InRangeV2 = 0xC842578241E646D8ull;
+		static constexpr uint64 NextNormal = 0x87840EF075A5D15Eull;
+		static constexpr uint64 NextExponential = 0x9E68B0FC786810D6ull;
+		static constexpr uint64 NextPoisson = 0xD55CE0646913CCF1ull;
+		static constexpr uint64 NextBinomial = 0xB3B121466363B2E5ull;
+		static constexpr uint64 Shuffle = 0xB071AF96D2789699ull;
+		static constexpr uint64 NextUint64 = 0x551242C23FD9E683ull;
+		static constexpr uint64 NextReal64 = 0xE7AD0D8624F90D82ull;
+		static constexpr uint64 NextInt64InRange64 = 0x2C38DFF9A8F3D527ull;
+		static constexpr uint64 Rd2D = 0x87C5DDD90D73F445ull;
+		static constexpr uint64 Halton2D = 0xC93729646CFD9FDAull;
+		static constexpr uint64 Sobol2D = 0xB4F73C75D5ECF740ull;
+	}
+
+	// The inline generator must stay usable in constant evaluation.
+	static_assert(TSquirrelRng<TFixedSeed<Seed>>(FSquirrelState()).NextUint32() == Raw::SquirrelNoise5(0, Seed));
+
+	template <typename T>
+	static uint64 Checksum(const TArray<T>& Values)
+	{
+		const uint8* Bytes = reinterpret_cast<const uint8*>(Values.GetData());
+		const int64 NumBytes = static_cast<int64>(Values.Num()) * sizeof(T);
+
+		uint64 Hash = 0xCBF29CE484222325ull;
+		for (int64 i = 0; i < NumBytes; ++i)
+		{
+			Hash ^= Bytes[i];
+			Hash *= 0x100000001B3ull;
+		}
+		return Hash;
+	}
+
+	template <typename T>
+	static bool BitwiseEqual(const TArray<T>& A, const TArray<T>& B)
+	{
+		return A.Num() == B.Num() && FMemory::Memcmp(A.GetData(), B.GetData(), A.Num() * sizeof(T)) == 0;
+	}
+
+	// Timed loops add their results in here once they finish, so that they can't be optimized away.
+	static std::atomic<uint64> GSink = 0;
+
+	template <typename T>
+	static void Consume(const T& Value)
+	{
+		uint64 Bits = 0;
+		FMemory::Memcpy(&Bits, &Value, FMath::Min(sizeof(T), sizeof(Bits)));
+		GSink.fetch_add(Bits, std::memory_order_relaxed);
+	}
+
+	static const TCHAR* LexToString(const Simd::EInstructionSet InstructionSet)
+	{
+		switch (InstructionSet)
+		{
+		case Simd::EInstructionSet::SSE41: return TEXT("SSE4.1");
+		case Simd::EInstructionSet::AVX2: return TEXT("AVX2");
+		case Simd::EInstructionSet::NEON: return TEXT("NEON");
+		default: return TEXT("Scalar");
+		}
+	}
+
+	class FRunner
+	{
+	public:
+		explicit FRunner(const FOptions& InOptions)
+		  : Options(InOptions)
+		{
+		}
+
+		bool Passed() const { return !bFailed; }
+
+		void Check(const FString& Name, const bool bPassed)
+		{
+			if (bPassed)
+			{
+				UE_LOG(LogSquirrel, Display, TEXT("  ok      %s"), *Name);
+			}
+			else
+			{
+				bFailed = true;
+				UE_LOG(LogSquirrel, Error, TEXT("  FAILED  %s"), *Name);
+			}
+		}
+
+		template <typename T>
+		void CheckGolden(const FString& Name, const TArray<T>& Values, const uint64 Expected)
+		{
+			const uint64 Actual = Checksum(Values);
+			if (Actual != Expected)
+			{
+				UE_LOG(LogSquirrel, Error, TEXT("  Checksum of %s is 0x%016llX, expected 0x%016llX"), *Name, Actual, Expected);
+			}
+			Check(Name + TEXT(" golden output"), Actual == Expected);
+		}
+
+		// Time Body, which generates Count values. Body is run once beforehand, to warm up the caches.
+		template <typename BodyType>
+		void Time(const FString& Name, const int64 Count, BodyType&& Body)
+		{
+			Body();
+
+			const double Start = FPlatformTime::Seconds();
+			Body();
+			const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, UE_DOUBLE_SMALL_NUMBER);
+
+			UE_LOG(LogSquirrel, Display, TEXT("  %-48s %10.2f ns/op %10.2f M values/s"), *Name,
+				Seconds * 1e9 / static_cast<double>(Count), static_cast<double>(Count) / Seconds / 1e6);
+		}
+
+		const FOptions Options;
+
+	private:
+		bool bFailed = false;
+	};
+
+	// Check a scalar generator against its golden output, and its batch version against the scalar one.
+	template <typename T, typename StateType = FSquirrelState, typename ScalarType, typename BatchType>
+	static void CheckGenerator(FRunner& Runner, const FString& Name, const uint64 Expected, ScalarType&& Scalar, BatchType&& Batch)
+	{
+		TArray<T> Reference;
+		Reference.SetNumUninitialized(GoldenCount);
+		StateType ReferenceState;
+		for (T& Value : Reference)
+		{
+			Value = Scalar(ReferenceState);
+		}
+
+		TArray<T> Batched;
+		Batched.SetNumUninitialized(GoldenCount);
+		StateType BatchState;
+		Batch(BatchState, MakeArrayView(Batched));
+
+		Runner.CheckGolden(Name, Reference, Expected);
+		Runner.Check(Name + TEXT(" batch == scalar"), BitwiseEqual(Batched, Reference) && BatchState.Position == ReferenceState.Position);
+	}
+
+	// Delta-serialize Sender against Base, and read the result into Receiver, as a connection would. Returns the number of
+	// bits written, or INDEX_NONE if nothing was.
+	template <typename T>
+	static int64 SendDelta(T& Sender, const TSharedPtr<INetDeltaBaseState>& Base, TSharedPtr<INetDeltaBaseState>& OutNewBase, T& Receiver)
+	{
+		FNetBitWriter Writer(256);
+		FNetDeltaSerializeInfo WriteParms;
+		WriteParms.Writer = &Writer;
+		WriteParms.OldState = Base.Get();
+		WriteParms.NewState = &OutNewBase;
+		if (!Sender.NetDeltaSerialize(WriteParms))
+		{
+			return INDEX_NONE;
+		}
+
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		FNetDeltaSerializeInfo ReadParms;
+		ReadParms.Reader = &Reader;
+		Receiver.NetDeltaSerialize(ReadParms);
+		return Writer.GetNumBits();
+	}
+
+	static TArray<FVector2D> MakePoints(const int32 Num, const double Radius)
+	{
+		TArray<FVector2D> Points;
+		Points.SetNumUninitialized(Num);
+		FSquirrelState State;
+		FillPointsInDisc(State, Radius, MakeArrayView(Points));
+		return Points;
+	}
+
+	static void RunChecks(FRunner& Runner)
+	{
+		UE_LOG(LogSquirrel, Display, TEXT("Checks:"));
+
+		CheckGenerator<uint32>(Runner, TEXT("Next<uint32>"), Golden::NextUint32,
+			[](FSquirrelState& State) { return Next<uint32>(State); },
+			[](FSquirrelState& State, const TArrayView<uint32> Out) { Fill(State, Out); });
+
+		CheckGenerator<double>(Runner, TEXT("NextReal"), Golden::NextReal,
+			[](FSquirrelState& State) { return NextReal(State); },
+			[](FSquirrelState& State, const TArrayView<double> Out) { Fill(State, Out); });
+
+		// The inline generator against the exported functions, reusing their golden output.
+		CheckGenerator<uint32>(Runner, TEXT("TSquirrelRng::NextUint32"), Golden::NextUint32,
+			[](FSquirrelState& State) { return Next<uint32>(State); },
+			[](FSquirrelState& State, const TArrayView<uint32> Out)
+			{
+				TSquirrelRng Rng(State);
+				for (uint32& Value : Out)
+				{
+					Value = Rng.NextUint32();
+				}
+				State = Rng.GetState();
+			});
+
+		CheckGenerator<double>(Runner, TEXT("TSquirrelRng::NextReal"), Golden::NextReal,
+			[](FSquirrelState& State) { return NextReal(State); },
+			[](FSquirrelState& State, const TArrayView<double> Out)
+			{
+				TSquirrelRng Rng(State);
+				for (double& Value : Out)
+				{
+					Value = Rng.NextReal();
+				}
+				State = Rng.GetState();
+			});
+
+		{
+			FSquirrelState State;
+			TSquirrelRng<TFixedSeed<Seed>> Rng(State);
+
+			bool bPassed = true;
+			for (int32 i = 0; i < GoldenCount; ++i)
+			{
+				const double Value = -50.0 + i * 0.0371;
+				double Roll = 0.0;
+				double RngRoll = 0.0;
+				bPassed &= NextInt32(State, 7) == Rng.NextInt32(7);
+				bPassed &= NextInt32InRange(State, -1000, 1000) == Rng.NextInt32InRange(-1000, 1000);
+				bPassed &= NextRealInRange(State, -2.5, 4.0) == Rng.NextRealInRange(-2.5, 4.0);
+				bPassed &= RollChance(State, Roll, 40.0, 10.0) == Rng.RollChance(RngRoll, 40.0, 10.0) && Roll == RngRoll;
+				bPassed &= RoundWithWeightByFraction(State, Value) == Rng.RoundWithWeightByFraction(Value);
+				bPassed &= Next<bool>(State) == Rng.Next<bool>();
+			}
+			Runner.Check(TEXT("TSquirrelRng == exported functions"), bPassed && Rng.GetState() == State);
+		}
+
+		CheckGenerator<int32>(Runner, TEXT("V2::NextInt32InRange"), Golden::NextInt32InRangeV2,
+			[](FSquirrelState& State) { return V2::NextInt32InRange(State, -1000, 1000); },
+			[](FSquirrelState& State, const TArrayView<int32> Out) { V2::FillInt32InRange(State, -1000, 1000, Out); });
+
+		// Integer-threshold rolls and stochastic rounding, batched against one at a time.
+		{
+			const V2::FChance Chance = V2::FChance::FromProbability(0.3);
+			TArray<V2::FChance> Chances;
+			for (int32 i = 0; i < 1001; ++i)
+			{
+				Chances.Add(V2::FChance::FromProbability(i / 1000.0));
+			}
+
+			FSquirrelState ReferenceState;
+			bool bPassed = true;
+			TArray<uint32> Mask;
+			Mask.SetNumUninitialized(FMath::DivideAndRoundUp(Chances.Num(), 32));
+
+			FSquirrelState MaskState;
+			V2::FillRolls(MaskState, Chance, Chances.Num(), Mask);
+			for (int32 i = 0; i < Chances.Num(); ++i)
+			{
+				bPassed &= V2::Roll(ReferenceState, Chance) == !!(Mask[i / 32] & (1u << (i % 32)));
+			}
+
+			V2::FillRolls(MaskState, Chances, Mask);
+			for (int32 i = 0; i < Chances.Num(); ++i)
+			{
+				bPassed &= V2::Roll(ReferenceState, Chances[i]) == !!(Mask[i / 32] & (1u << (i % 32)));
+			}
+			Runner.Check(TEXT("V2::FillRolls == V2::Roll"), bPassed && MaskState == ReferenceState);
+
+			TArray<float> Values;
+			for (int32 i = 0; i < GoldenCount; ++i)
+			{
+				Values.Add(-50.0f + i * 0.0371f);
+			}
+			TArray<float> Rounded = Values;
+			FSquirrelState RoundState;
+			V2::RoundStochastic(RoundState, MakeArrayView(Rounded));
+
+			bPassed = true;
+			for (int32 i = 0; i < Values.Num(); ++i)
+			{
+				bPassed &= static_cast<float>(V2::RoundStochastic(ReferenceState, Values[i])) == Rounded[i];
+			}
+			Runner.Check(TEXT("V2::RoundStochastic (batch) == V2::RoundStochastic"), bPassed);
+		}
+
+		CheckGenerator<uint64, FSquirrelState64>(Runner, TEXT("Next<uint64> (64-bit state)"), Golden::NextUint64,
+			[](FSquirrelState64& State) { return Next<uint64>(State); },
+			[](FSquirrelState64& State, const TArrayView<uint64> Out) { Fill(State, Out); });
+
+		CheckGenerator<double, FSquirrelState64>(Runner, TEXT("NextReal (64-bit state)"), Golden::NextReal64,
+			[](FSquirrelState64& State) { return NextReal(State); },
+			[](FSquirrelState64& State, const TArrayView<double> Out) { Fill(State, Out); });
+
+		CheckGenerator<int64, FSquirrelState64>(Runner, TEXT("NextInt64InRange (64-bit state)"), Golden::NextInt64InRange64,
+			[](FSquirrelState64& State) { return NextInt64InRange(State, -1000, 1000); },
+			[](FSquirrelState64& State, const TArrayView<int64> Out) { FillInt64InRange(State, -1000, 1000, Out); });
+
+		CheckGenerator<FVector2D>(Runner, TEXT("LowDiscrepancy::Next2D (Rd)"), Golden::Rd2D,
+			[](FSquirrelState& State) { return LowDiscrepancy::Next2D(State, LowDiscrepancy::ESequence::Rd); },
+			[](FSquirrelState& State, const TArrayView<FVector2D> Out) { LowDiscrepancy::Fill(State, LowDiscrepancy::ESequence::Rd, Out); });
+
+		CheckGenerator<FVector2D>(Runner, TEXT("LowDiscrepancy::Next2D (Halton)"), Golden::Halton2D,
+			[](FSquirrelState& State) { return LowDiscrepancy::Next2D(State, LowDiscrepancy::ESequence::Halton); },
+			[](FSquirrelState& State, const TArrayView<FVector2D> Out) { LowDiscrepancy::Fill(State, LowDiscrepancy::ESequence::Halton, Out); });
+
+		CheckGenerator<FVector2D>(Runner, TEXT("LowDiscrepancy::Next2D (Sobol)"), Golden::Sobol2D,
+			[](FSquirrelState& State) { return LowDiscrepancy::Next2D(State, LowDiscrepancy::ESequence::Sobol); },
+			[](FSquirrelState& State, const TArrayView<FVector2D> Out) { LowDiscrepancy::Fill(State, LowDiscrepancy::ESequence::Sobol, Out); });
+
+		// Scrambled Sobol must keep its stratification: the first 2^8 points of the first two axes form a (0,8,2)-net, with
+		// exactly one point in every elementary interval.
+		{
+			constexpr int32 Log2Num = 8;
+			TArray<FVector2D> Points;
+			Points.SetNumUninitialized(1 << Log2Num);
+			FSquirrelState State;
+			LowDiscrepancy::Fill(State, LowDiscrepancy::ESequence::Sobol, MakeArrayView(Points));
+
+			bool bPassed = true;
+			for (int32 Log2X = 0; Log2X <= Log2Num; ++Log2X)
+			{
+				TArray<int32> Counts;
+				Counts.SetNumZeroed(Points.Num());
+				for (const FVector2D& Point : Points)
+				{
+					const int32 X = static_cast<int32>(Point.X * (1 << Log2X));
+					const int32 Y = static_cast<int32>(Point.Y * (1 << (Log2Num - Log2X)));
+					++Counts[(X << (Log2Num - Log2X)) + Y];
+				}
+				bPassed &= !Counts.ContainsByPredicate([](const int32 Count) { return Count != 1; });
+			}
+			Runner.Check(TEXT("LowDiscrepancy Sobol (0,8,2)-net"), bPassed);
+		}
+
+		CheckGenerator<double>(Runner, TEXT("NextNormal"), Golden::NextNormal,
+			[](FSquirrelState& State) { return NextNormal(State); },
+			[](FSquirrelState& State, const TArrayView<double> Out) { FillNormal(State, Out); });
+
+		CheckGenerator<double>(Runner, TEXT("NextExponential"), Golden::NextExponential,
+			[](FSquirrelState& State) { return NextExponential(State); },
+			[](FSquirrelState& State, const TArrayView<double> Out) { FillExponential(State, Out); });
+
+		CheckGenerator<int32>(Runner, TEXT("NextPoisson"), Golden::NextPoisson,
+			[](FSquirrelState& State) { return NextPoisson(State, 4.5); },
+			[](FSquirrelState& State, const TArrayView<int32> Out) { FillPoisson(State, Out, 4.5); });
+
+		CheckGenerator<int32>(Runner, TEXT("NextBinomial"), Golden::NextBinomial,
+			[](FSquirrelState& State) { return NextBinomial(State, 100, 0.3); },
+			[](FSquirrelState& State, const TArrayView<int32> Out) { FillBinomial(State, Out, 100, 0.3); });
+
+		// Shuffling, and sampling without replacement through both the dense and the sparse path.
+		{
+			TArray<int32> Deck;
+			for (int32 i = 0; i < 1024; ++i)
+			{
+				Deck.Add(i);
+			}
+			FSquirrelState State;
+			Shuffle(State, Deck);
+			Runner.CheckGolden(TEXT("Shuffle"), Deck, Golden::Shuffle);
+
+			TArray<int32> Dense;
+			FSquirrelState DenseState;
+			SampleWithoutReplacement(DenseState, Deck.Num(), Deck.Num(), Dense);
+			Runner.Check(TEXT("SampleWithoutReplacement (dense) == Shuffle"), BitwiseEqual(Dense, Deck));
+
+			TArray<int32> LargeDeck;
+			for (int32 i = 0; i < 1 << 16; ++i)
+			{
+				LargeDeck.Add(i);
+			}
+			FSquirrelState LargeState;
+			Shuffle(LargeState, LargeDeck);
+			LargeDeck.SetNum(64);
+
+			TArray<int32> Sparse;
+			FSquirrelState SparseState;
+			SampleWithoutReplacement(SparseState, 1 << 16, 64, Sparse);
+			Runner.Check(TEXT("SampleWithoutReplacement (sparse) == Shuffle"), BitwiseEqual(Sparse, LargeDeck));
+		}
+
+		// The SIMD kernels, with an unaligned start and count, and across the int32 wrap-around.
+		{
+			const FString InstructionSet = LexToString(Simd::GetInstructionSet());
+			constexpr int32 Count = 1001;
+
+			bool bSequencePassed = true;
+			for (const int32 Start : { -37, MAX_int32 - 100 })
+			{
+				uint32 Vector[Count];
+				Simd::NoiseSequence(Vector, Count, Start, Seed);
+				for (int32 i = 0; i < Count; ++i)
+				{
+					bSequencePassed &= Vector[i] == Raw::SquirrelNoise5(static_cast<int32>(static_cast<uint32>(Start) + static_cast<uint32>(i)), Seed);
+				}
+			}
+			Runner.Check(FString::Printf(TEXT("NoiseSequence (%s) == SquirrelNoise5"), *InstructionSet), bSequencePassed);
+
+			int32 Indices[Count];
+			uint32 Vector[Count];
+			FSquirrelState State;
+			Fill(State, MakeArrayView(reinterpret_cast<uint32*>(Indices), Count));
+			Simd::NoiseGather(Vector, Indices, Count, Seed);
+
+			bool bGatherPassed = true;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				bGatherPassed &= Vector[i] == Raw::SquirrelNoise5(Indices[i], Seed);
+			}
+			Runner.Check(FString::Printf(TEXT("NoiseGather (%s) == SquirrelNoise5"), *InstructionSet), bGatherPassed);
+		}
+
+		// Grids, which run through ISPC where it is enabled.
+		{
+			FSquirrelGrid2D Layout;
+			Layout.Origin = FIntPoint(-50, 20);
+			Layout.Size = FIntPoint(301, 77);
+			Layout.Stride = FIntPoint(3, 2);
+			Layout.Seed = Seed;
+
+			TArray<uint32> Cells;
+			Cells.SetNumUninitialized(Layout.Num());
+			Grid::Fill2dNoiseUint(Layout, Cells);
+
+			bool bPassed = true;
+			for (int32 Y = 0; Y < Layout.Size.Y; ++Y)
+			{
+				for (int32 X = 0; X < Layout.Size.X; ++X)
+				{
+					bPassed &= Cells[X + Y * Layout.Size.X] == Raw::Get2dNoiseUint(Layout.Origin.X + X * Layout.Stride.X, Layout.Origin.Y + Y * Layout.Stride.Y, Seed);
+				}
+			}
+			Runner.Check(TEXT("Fill2dNoiseUint == Get2dNoiseUint"), bPassed);
+		}
+
+		// Batched fractals against single points, for every combination of settings.
+		{
+			const TArray<FVector2D> Points = MakePoints(GoldenCount, 64.0);
+
+			for (const ESquirrelNoiseBasis Basis : { ESquirrelNoiseBasis::Value, ESquirrelNoiseBasis::Gradient })
+			{
+				for (const ESquirrelFractalType Type : { ESquirrelFractalType::FBm, ESquirrelFractalType::Ridged, ESquirrelFractalType::Turbulence })
+				{
+					FSquirrelFractalSettings Settings;
+					Settings.Basis = Basis;
+					Settings.Type = Type;
+					Settings.Octaves = 5;
+
+					TArray<double> Batched;
+					Batched.SetNumUninitialized(Points.Num());
+					Noise::SampleFractal2D(Settings, Seed, Points, Batched);
+
+					TArray<double> Reference;
+					for (const FVector2D& Point : Points)
+					{
+						Reference.Add(Noise::Fractal2D(Settings, Point, Seed));
+					}
+
+					Runner.Check(FString::Printf(TEXT("SampleFractal2D == Fractal2D (%s, %s)"),
+						*UEnum::GetValueAsString(Basis), *UEnum::GetValueAsString(Type)), BitwiseEqual(Batched, Reference));
+				}
+			}
+		}
+
+		// Batched cellular noise against single points.
+		{
+			const TArray<FVector2D> Points = MakePoints(GoldenCount, 64.0);
+
+			for (const bool bF1Only : { false, true })
+			{
+				FSquirrelCellularSettings Settings;
+				Settings.bF1Only = bF1Only;
+
+				TArray<FSquirrelCellularResult> Batched;
+				Batched.SetNumUninitialized(Points.Num());
+				Cellular::SampleCellular2D(Settings, Seed, Points, Batched);
+
+				TArray<FSquirrelCellularResult> Reference;
+				for (const FVector2D& Point : Points)
+				{
+					Reference.Add(Cellular::Cellular2D(Settings, Point, Seed));
+				}
+
+				Runner.Check(FString::Printf(TEXT("SampleCellular2D == Cellular2D (F1 only: %d)"), bF1Only), BitwiseEqual(Batched, Reference));
+			}
+		}
+
+		// A compiled noise graph against its nodes evaluated one at a time. The unused node and the warp input that is read
+		// again at the end exercise the compiler's liveness analysis and register reuse.
+		{
+			const TArray<FVector2D> Points2D = MakePoints(GoldenCount, 64.0);
+			TArray<FVector> Points;
+			for (const FVector2D& Point : Points2D)
+			{
+				Points.Add(FVector(Point.X, Point.Y, Point.X - Point.Y));
+			}
+
+			for (const ESquirrelNoiseGraphDimensions Dimensions : { ESquirrelNoiseGraphDimensions::Two, ESquirrelNoiseGraphDimensions::Three })
+			{
+				const TStrongObjectPtr<USquirrelNoiseGraph> Graph(NewObject<USquirrelNoiseGraph>(GetTransientPackage()));
+				Graph->Dimensions = Dimensions;
+
+				auto AddNode = [&Graph](const ESquirrelNoiseOp Op, const int32 SeedOffset = 0)
+				{
+					FSquirrelNoiseGraphNode& Node = Graph->Nodes.AddDefaulted_GetRef();
+					Node.Op = Op;
+					Node.SeedOffset = SeedOffset;
+					Node.Fractal.Octaves = 3;
+					return Graph->Nodes.Num() - 1;
+				};
+
+				const int32 WarpX = AddNode(ESquirrelNoiseOp::Fractal, 1);
+				const int32 WarpY = AddNode(ESquirrelNoiseOp::Fractal, 2);
+				const int32 Warp = AddNode(ESquirrelNoiseOp::Warp);
+				Graph->Nodes[Warp].InputA = WarpX;
+				Graph->Nodes[Warp].InputB = WarpY;
+				Graph->Nodes[Warp].InputC = WarpX;
+				Graph->Nodes[Warp].Value = 8.0;
+
+				const int32 Warped = AddNode(ESquirrelNoiseOp::Fractal, 3);
+				Graph->Nodes[Warped].PositionInput = Warp;
+				Graph->Nodes[Warped].Fractal.Basis = ESquirrelNoiseBasis::Value;
+				Graph->Nodes[Warped].Fractal.Octaves = 5;
+
+				const int32 Remapped = AddNode(ESquirrelNoiseOp::Remap);
+				Graph->Nodes[Remapped].InputA = Warped;
+				Graph->Nodes[Remapped].OutRange = FVector2D(-0.5, 2.0);
+
+				AddNode(ESquirrelNoiseOp::Hash, 4);
+
+				const int32 Detail = AddNode(ESquirrelNoiseOp::Noise, 5);
+				Graph->Nodes[Detail].Fractal.Frequency = 0.25;
+
+				const int32 Blend = AddNode(ESquirrelNoiseOp::Blend);
+				Graph->Nodes[Blend].InputA = Remapped;
+				Graph->Nodes[Blend].InputB = Detail;
+				Graph->Nodes[Blend].InputC = WarpY;
+
+				const bool bCompiled = Graph->Compile();
+
+				TArray<double> Batched;
+				Graph->EvaluateBatch(Points, Seed, Batched);
+
+				TArray<double> Reference;
+				for (const FVector& Point : Points)
+				{
+					Reference.Add(Graph->EvaluateReference(Point, Seed));
+				}
+
+				Runner.Check(FString::Printf(TEXT("USquirrelNoiseGraph batch == reference (%s)"), *UEnum::GetValueAsString(Dimensions)),
+					bCompiled && BitwiseEqual(Batched, Reference));
+			}
+		}
+
+		// Weighted tables.
+		{
+			TArray<double> Weights;
+			Weights.SetNumUninitialized(100);
+			FSquirrelState WeightState;
+			Fill(WeightState, MakeArrayView(Weights));
+			FSquirrelWeightedTable Table(Weights);
+
+			TArray<int32> Batched;
+			Batched.SetNumUninitialized(GoldenCount);
+			FSquirrelState BatchState;
+			Table.Sample(BatchState, Batched);
+
+			TArray<int32> Reference;
+			FSquirrelState ReferenceState;
+			for (int32 i = 0; i < GoldenCount; ++i)
+			{
+				Reference.Add(Table.Sample(ReferenceState));
+			}
+
+			Runner.Check(TEXT("FSquirrelWeightedTable batch == scalar"), BitwiseEqual(Batched, Reference) && BatchState.Position == ReferenceState.Position);
+		}
+
+		// The incremental saves and restores of the state registry against a reference that copies every state of every
+		// frame, through random edits, skipped frames, rollbacks, and rollbacks to frames that are gone.
+		{
+			constexpr int32 Capacity = 2048;
+			constexpr int32 NumFrames = 8;
+
+			FSquirrelStateRegistry Registry(Capacity, NumFrames);
+			TArray<FSquirrelState> ReferenceStates;
+			ReferenceStates.SetNumZeroed(Capacity);
+			TMap<int32, TArray<FSquirrelState>> ReferenceFrames;
+
+			TArray<FSquirrelStateHandle> Handles;
+			FSquirrelState Rng;
+			bool bPassed = true;
+			int64 Copied = 0;
+			int32 Frame = INDEX_NONE;
+
+			auto Register = [&]
+			{
+				const FSquirrelState Initial{ Next<int32>(Rng) };
+				const FSquirrelStateHandle Handle = Registry.Register(Initial);
+				Handles.Add(Handle);
+				ReferenceStates[Handle.Index] = Initial;
+			};
+			for (int32 i = 0; i < Capacity / 2; ++i)
+			{
+				Register();
+			}
+
+			constexpr int32 NumSteps = 2000;
+			for (int32 Step = 0; Step < NumSteps; ++Step)
+			{
+				// Streams come and go.
+				const int32 Churn = NextInt32(Rng, 4);
+				if (Churn == 0 && Handles.Num() < Capacity)
+				{
+					Register();
+				}
+				else if (Churn == 1 && !Handles.IsEmpty())
+				{
+					const int32 Removed = NextInt32(Rng, Handles.Num());
+					Registry.Unregister(Handles[Removed]);
+					Handles.RemoveAtSwap(Removed);
+				}
+
+				// A few streams generate.
+				const int32 NumEdits = NextInt32InRange(Rng, 0, 8);
+				for (int32 i = 0; i < NumEdits && !Handles.IsEmpty(); ++i)
+				{
+					const FSquirrelStateHandle Handle = Handles[NextInt32(Rng, Handles.Num())];
+					Next<uint32>(Registry.Edit(Handle));
+					Next<uint32>(ReferenceStates[Handle.Index]);
+				}
+
+				if (Frame == INDEX_NONE || NextInt32(Rng, 10) < 7)
+				{
+					Frame += NextInt32InRange(Rng, 1, 3);
+					Registry.SaveFrame(Frame);
+					Copied += Registry.GetLastCopyCount();
+
+					// Saving a frame overwrites the one in the same slot.
+					for (auto It = ReferenceFrames.CreateIterator(); It; ++It)
+					{
+						if (It.Key() % NumFrames == Frame % NumFrames)
+						{
+							It.RemoveCurrent();
+						}
+					}
+					ReferenceFrames.Add(Frame, ReferenceStates);
+				}
+				else
+				{
+					const int32 Target = Frame - NextInt32InRange(Rng, 0, NumFrames + 2);
+					const bool bRestored = Registry.RestoreFrame(Target);
+					bPassed &= bRestored == ReferenceFrames.Contains(Target);
+
+					if (bRestored)
+					{
+						Copied += Registry.GetLastCopyCount();
+						ReferenceStates = ReferenceFrames[Target];
+						for (auto It = ReferenceFrames.CreateIterator(); It; ++It)
+						{
+							if (It.Key() > Target)
+							{
+								It.RemoveCurrent();
+							}
+						}
+						Frame = Target;
+					}
+				}
+
+				for (const FSquirrelStateHandle Handle : Handles)
+				{
+					bPassed &= Registry.Get(Handle) == ReferenceStates[Handle.Index];
+				}
+				for (int32 Saved = FMath::Max(Frame - 2 * NumFrames, 0); Saved <= Frame; ++Saved)
+				{
+					bPassed &= Registry.HasFrame(Saved) == ReferenceFrames.Contains(Saved);
+				}
+			}
+
+			Runner.Check(TEXT("FSquirrelStateRegistry == full copies"), bPassed);
+			Runner.Check(TEXT("FSquirrelStateRegistry copies incrementally"), Copied < static_cast<int64>(NumSteps) * Capacity / 2);
+		}
+
+		// Seeded parallel loops must not depend on scheduling.
+		{
+			auto RunLoop = [](const EParallelForFlags Flags)
+			{
+				TArray<uint32> Results;
+				Results.SetNumZeroed(GoldenCount);
+				FSquirrelState State;
+				ParallelForSeeded(GoldenCount, State, [&Results](const int32 Index, FSquirrelState& IndexState)
+				{
+					Results[Index] = Next<uint32>(IndexState) ^ Next<uint32>(IndexState);
+				}, Flags);
+				return Results;
+			};
+
+			Runner.Check(TEXT("ParallelForSeeded is independent of threading"),
+				BitwiseEqual(RunLoop(EParallelForFlags::None), RunLoop(EParallelForFlags::ForceSingleThread)));
+		}
+
+		// Replicated states must arrive intact, in full or as deltas against the last state sent, including after a lost packet.
+		{
+			FSquirrelState Rng;
+			bool bPassed = true;
+			bool bCompact = true;
+
+			for (int32 Trial = 0; Trial < 256; ++Trial)
+			{
+				FSquirrelWorldState Sender{ Next<uint32>(Rng), FSquirrelState{ Next<int32>(Rng) } };
+				FSquirrelWorldState Receiver;
+				FSquirrelWorldState Dropped;
+				TSharedPtr<INetDeltaBaseState> Acked;
+				TSharedPtr<INetDeltaBaseState> Sent;
+
+				// Without a base, the state is written in full. Once it is acknowledged, an unchanged state isn't written.
+				bPassed &= SendDelta(Sender, nullptr, Acked, Receiver) != INDEX_NONE && Receiver == Sender;
+				bPassed &= SendDelta(Sender, Acked, Sent, Receiver) == INDEX_NONE;
+
+				// A stream that advanced by a few draws.
+				Sender.RuntimeState.Position += NextInt32InRange(Rng, 1, 63);
+				bCompact &= SendDelta(Sender, Acked, Sent, Receiver) <= 18;
+				bPassed &= Receiver == Sender;
+				Acked = Sent;
+
+				// A jump to anywhere, wrapping around, along with a new seed.
+				Sender.GlobalSeed = Next<uint32>(Rng);
+				Sender.RuntimeState.Position = Next<int32>(Rng);
+				bPassed &= SendDelta(Sender, Acked, Sent, Receiver) != INDEX_NONE && Receiver == Sender;
+				Acked = Sent;
+
+				// A packet is lost, and the next one is written against it, so the receiver must skip it. Once the sender
+				// rolls back to the acknowledged base, the receiver catches up.
+				TSharedPtr<INetDeltaBaseState> Lost;
+				const FSquirrelWorldState BeforeLoss = Receiver;
+				Sender.RuntimeState.Position += NextInt32InRange(Rng, 1, 255);
+				SendDelta(Sender, Acked, Lost, Dropped);
+				Sender.RuntimeState.Position += NextInt32InRange(Rng, 1, 255);
+				SendDelta(Sender, Lost, Sent, Receiver);
+				bPassed &= Receiver == BeforeLoss;
+				bPassed &= SendDelta(Sender, Acked, Sent, Receiver) != INDEX_NONE && Receiver == Sender;
+
+				// The stream state alone, as a replicated property of its own.
+				FSquirrelState StateSender{ Next<int32>(Rng) };
+				FSquirrelState StateReceiver;
+				TSharedPtr<INetDeltaBaseState> StateAcked;
+				bPassed &= SendDelta(StateSender, nullptr, StateAcked, StateReceiver) != INDEX_NONE && StateReceiver == StateSender;
+				StateSender.Position -= NextInt32InRange(Rng, 1, 63);
+				bCompact &= SendDelta(StateSender, StateAcked, Sent, StateReceiver) <= 18;
+				bPassed &= StateReceiver == StateSender;
+			}
+
+			Runner.Check(TEXT("NetDeltaSerialize round trip"), bPassed);
+			Runner.Check(TEXT("NetDeltaSerialize of a few draws fits in 18 bits"), bCompact);
+		}
+
+		// Squirrels spawned on many threads at once must each get a different position, and together get exactly the
+		// positions that spawning them one after another would have.
+		{
+			constexpr int32 StartPosition = -GoldenCount * 8;
+			constexpr int32 NumWorkers = 64;
+			constexpr int32 SpawnsPerWorker = GoldenCount;
+
+			FSquirrelContext SpawnContext(Seed, StartPosition);
+			TArray<int32> Positions;
+			Positions.SetNumUninitialized(NumWorkers * SpawnsPerWorker);
+
+			Runner.Time(FString::Printf(TEXT("FSquirrelContext::NewPosition, %d workers"), NumWorkers), Positions.Num(), [&SpawnContext, &Positions]
+			{
+				SpawnContext.LoadState(FSquirrelWorldState{ Seed, FSquirrelState{ StartPosition } });
+				ParallelFor(NumWorkers, [&SpawnContext, &Positions](const int32 Worker)
+				{
+					for (int32 i = 0; i < SpawnsPerWorker; ++i)
+					{
+						Positions[Worker * SpawnsPerWorker + i] = SpawnContext.NewPosition();
+					}
+				}, EParallelForFlags::Unbalanced);
+			});
+
+			TArray<int32> Expected;
+			Expected.Reserve(Positions.Num());
+			FSquirrelState State{ StartPosition };
+			for (int32 i = 0; i < Positions.Num(); ++i)
+			{
+				Expected.Add(Next<int32>(State));
+			}
+
+			Positions.Sort();
+			Expected.Sort();
+
+			bool bUnique = true;
+			for (int32 i = 1; i < Positions.Num(); ++i)
+			{
+				bUnique &= Positions[i - 1] != Positions[i];
+			}
+
+			Runner.Check(TEXT("NewPosition is unique across threads"), bUnique);
+			Runner.Check(TEXT("NewPosition across threads == Next<int32>"), BitwiseEqual(Positions, Expected) &&
+				SpawnContext.SaveState().RuntimeState.Position == State.Position);
+		}
+
+		// Scattering must not depend on how the plane is divided into regions.
+		{
+			FSquirrelPoissonDiskSettings Settings;
+			Settings.Radius = 10.0;
+			Settings.Seed = Seed;
+
+			TArray<FVector2D> Whole;
+			Scatter::PoissonDisk(Settings, FBox2D(FVector2D(-500.0), FVector2D(500.0)), Whole);
+
+			TArray<FVector2D> Halves;
+			Scatter::PoissonDisk(Settings, FBox2D(FVector2D(-500.0), FVector2D(0.0, 500.0)), Halves);
+			Scatter::PoissonDisk(Settings, FBox2D(FVector2D(0.0, -500.0), FVector2D(500.0)), Halves);
+
+			auto SortPoints = [](TArray<FVector2D>& Points)
+			{
+				Points.Sort([](const FVector2D& A, const FVector2D& B) { return A.X < B.X || (A.X == B.X && A.Y < B.Y); });
+			};
+			SortPoints(Whole);
+			SortPoints(Halves);
+
+			Runner.Check(TEXT("PoissonDisk is independent of region division"), BitwiseEqual(Whole, Halves));
+		}
+	}
+
+	static void RunTimings(FRunner& Runner)
+	{
+		const int32 Num = Runner.Options.Iterations;
+
+		// Noise functions evaluate many hashes per point, so they are given fewer points to keep run times similar.
+		const int32 NumPoints = FMath::Max(Num / 8, 1);
+		const TArray<FVector2D> Points = MakePoints(NumPoints, 1000.0);
+
+		TArray<uint32> Uints;
+		TArray<int32> Ints;
+		TArray<double> Doubles;
+		TArray<FVector> Vectors;
+		Uints.SetNumUninitialized(Num);
+		Ints.SetNumUninitialized(Num);
+		Doubles.SetNumUninitialized(Num);
+		Vectors.SetNumUninitialized(Num);
+
+		FSquirrelState State;
+
+		UE_LOG(LogSquirrel, Display, TEXT("Generators:"));
+
+		Runner.Time(TEXT("SquirrelNoise5"), Num, [Num]
+		{
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += Raw::SquirrelNoise5(i, Seed);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("Squirrel::Next<uint32>"), Num, [Num, &State]
+		{
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += Next<uint32>(State);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("Squirrel::Fill (uint32)"), Num, [&State, &Uints] { Fill(State, MakeArrayView(Uints)); });
+
+		Runner.Time(TEXT("Squirrel::NextReal"), Num, [Num, &State]
+		{
+			double Sum = 0.0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += NextReal(State);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("Squirrel::Fill (double)"), Num, [&State, &Doubles] { Fill(State, MakeArrayView(Doubles)); });
+
+		Runner.Time(TEXT("Squirrel::RollChance"), Num, [Num, &State]
+		{
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				double Roll;
+				Sum += RollChance(State, Roll, 30.0, 0.0);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("V2::Roll"), Num, [Num, &State]
+		{
+			const V2::FChance Chance = V2::FChance::FromRollChance(30.0, 0.0);
+			uint32 Sum = 0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += V2::Roll(State, Chance);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("V2::FillRolls"), Num, [Num, &State, &Uints]
+		{
+			V2::FillRolls(State, V2::FChance::FromRollChance(30.0, 0.0), Num, MakeArrayView(Uints));
+		});
+
+		Runner.Time(TEXT("V2::RoundStochastic (double, batch)"), Num, [&State, &Doubles] { V2::RoundStochastic(State, MakeArrayView(Doubles)); });
+
+		{
+			FSquirrelState64 State64;
+			Runner.Time(TEXT("Squirrel::NextReal (64-bit state)"), Num, [Num, &State64]
+			{
+				double Sum = 0.0;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Sum += NextReal(State64);
+				}
+				Consume(Sum);
+			});
+
+			Runner.Time(TEXT("Squirrel::Fill (double, 64-bit state)"), Num, [&State64, &Doubles] { Fill(State64, MakeArrayView(Doubles)); });
+		}
+
+		Runner.Time(TEXT("TSquirrelRng::NextReal"), Num, [Num, &State]
+		{
+			TSquirrelRng Rng(State);
+			double Sum = 0.0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += Rng.NextReal();
+			}
+			State = Rng.GetState();
+			Consume(Sum);
+		});
+
+		{
+			TArray<FVector2D> Sequence;
+			Sequence.SetNumUninitialized(Num);
+
+			for (const LowDiscrepancy::ESequence Type : { LowDiscrepancy::ESequence::Rd, LowDiscrepancy::ESequence::Halton, LowDiscrepancy::ESequence::Sobol })
+			{
+				static const TCHAR* Names[] = { TEXT("Rd"), TEXT("Halton"), TEXT("Sobol") };
+				Runner.Time(FString::Printf(TEXT("LowDiscrepancy::Fill (FVector2D, %s)"), Names[static_cast<int32>(Type)]), Num,
+					[&State, &Sequence, Type] { LowDiscrepancy::Fill(State, Type, MakeArrayView(Sequence)); });
+			}
+		}
+
+		{
+			const TStrongObjectPtr<USquirrel> Object(NewObject<USquirrel>(GetTransientPackage()));
+
+			Runner.Time(TEXT("USquirrel::NextReal (native)"), Num, [Num, &Object]
+			{
+				double Sum = 0.0;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Sum += Object->NextReal();
+				}
+				Consume(Sum);
+			});
+
+			UFunction* Function = Object->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(USquirrel, NextReal));
+			Runner.Time(TEXT("USquirrel::NextReal (Blueprint VM)"), Num, [Num, &Object, Function]
+			{
+				struct
+				{
+					double ReturnValue = 0.0;
+				} Params;
+
+				double Sum = 0.0;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Object->ProcessEvent(Function, &Params);
+					Sum += Params.ReturnValue;
+				}
+				Consume(Sum);
+			});
+		}
+
+		Runner.Time(TEXT("Squirrel::NextInt32InRange"), Num, [Num, &State]
+		{
+			int32 Sum = 0;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += NextInt32InRange(State, -1000, 1000);
+			}
+			Consume(Sum);
+		});
+
+		for (const V2::EBoundedMode Mode : { V2::EBoundedMode::Fast, V2::EBoundedMode::Unbiased })
+		{
+			const TCHAR* ModeName = Mode == V2::EBoundedMode::Fast ? TEXT("Fast") : TEXT("Unbiased");
+
+			Runner.Time(FString::Printf(TEXT("V2::NextInt32InRange (%s)"), ModeName), Num, [Num, &State, Mode]
+			{
+				int32 Sum = 0;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Sum += V2::NextInt32InRange(State, -1000, 1000, Mode);
+				}
+				Consume(Sum);
+			});
+
+			Runner.Time(FString::Printf(TEXT("V2::FillInt32InRange (%s)"), ModeName), Num,
+				[&State, &Ints, Mode] { V2::FillInt32InRange(State, -1000, 1000, Ints, Mode); });
+		}
+
+		UE_LOG(LogSquirrel, Display, TEXT("Distributions:"));
+
+		auto TimeDistribution = [&Runner, &State, Num](const TCHAR* Name, auto&& Scalar, auto&& Batch)
+		{
+			Runner.Time(Name, Num, [&Scalar, &State, Num]
+			{
+				double Sum = 0.0;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Sum += Scalar(State);
+				}
+				Consume(Sum);
+			});
+			Runner.Time(FString::Printf(TEXT("%s (batch)"), Name), Num, [&Batch, &State] { Batch(State); });
+		};
+
+		TimeDistribution(TEXT("NextNormal"),
+			[](FSquirrelState& S) { return NextNormal(S); },
+			[&Doubles](FSquirrelState& S) { FillNormal(S, Doubles); });
+		TimeDistribution(TEXT("NextExponential"),
+			[](FSquirrelState& S) { return NextExponential(S); },
+			[&Doubles](FSquirrelState& S) { FillExponential(S, Doubles); });
+		TimeDistribution(TEXT("NextPoisson (mean 4.5)"),
+			[](FSquirrelState& S) { return NextPoisson(S, 4.5); },
+			[&Ints](FSquirrelState& S) { FillPoisson(S, Ints, 4.5); });
+		TimeDistribution(TEXT("NextPoisson (mean 250)"),
+			[](FSquirrelState& S) { return NextPoisson(S, 250.0); },
+			[&Ints](FSquirrelState& S) { FillPoisson(S, Ints, 250.0); });
+		TimeDistribution(TEXT("NextBinomial (100, 0.3)"),
+			[](FSquirrelState& S) { return NextBinomial(S, 100, 0.3); },
+			[&Ints](FSquirrelState& S) { FillBinomial(S, Ints, 100, 0.3); });
+		TimeDistribution(TEXT("NextTriangular"),
+			[](FSquirrelState& S) { return NextTriangular(S, 0.0, 0.25, 1.0); },
+			[&Doubles](FSquirrelState& S) { FillTriangular(S, Doubles, 0.0, 0.25, 1.0); });
+
+		UE_LOG(LogSquirrel, Display, TEXT("Geometry and collections:"));
+
+		Runner.Time(TEXT("NextUnitVector"), Num, [Num, &State]
+		{
+			FVector Sum = FVector::ZeroVector;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Sum += NextUnitVector(State);
+			}
+			Consume(Sum.X);
+		});
+
+		Runner.Time(TEXT("FillUnitVectors"), Num, [&State, &Vectors] { FillUnitVectors(State, Vectors); });
+
+		{
+			TArray<double> Weights;
+			Weights.SetNumUninitialized(1024);
+			Fill(State, MakeArrayView(Weights));
+			FSquirrelWeightedTable Table(Weights);
+			Table.Build();
+
+			Runner.Time(TEXT("FSquirrelWeightedTable::Sample (1024 weights)"), Num, [Num, &State, &Table]
+			{
+				int32 Sum = 0;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Sum += Table.Sample(State);
+				}
+				Consume(Sum);
+			});
+
+			Runner.Time(TEXT("FSquirrelWeightedTable::Sample (batch)"), Num, [&State, &Table, &Ints] { Table.Sample(State, Ints); });
+		}
+
+		Runner.Time(TEXT("Shuffle"), Num, [&State, &Ints] { Shuffle(State, Ints); });
+
+		UE_LOG(LogSquirrel, Display, TEXT("Noise:"));
+
+		FSquirrelFractalSettings Fractal;
+		Fractal.Octaves = 5;
+
+		Runner.Time(TEXT("Noise::Value2D"), NumPoints, [&Points]
+		{
+			double Sum = 0.0;
+			for (const FVector2D& Point : Points)
+			{
+				Sum += Noise::Value2D(Point, Seed);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("Noise::Gradient2D"), NumPoints, [&Points]
+		{
+			double Sum = 0.0;
+			for (const FVector2D& Point : Points)
+			{
+				Sum += Noise::Gradient2D(Point, Seed);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("Noise::Fractal2D (5 octaves)"), NumPoints, [&Points, &Fractal]
+		{
+			double Sum = 0.0;
+			for (const FVector2D& Point : Points)
+			{
+				Sum += Noise::Fractal2D(Fractal, Point, Seed);
+			}
+			Consume(Sum);
+		});
+
+		Runner.Time(TEXT("Noise::SampleFractal2D (5 octaves)"), NumPoints,
+			[&Points, &Fractal, &Doubles] { Noise::SampleFractal2D(Fractal, Seed, Points, MakeArrayView(Doubles.GetData(), Points.Num())); });
+
+		{
+			const FSquirrelCellularSettings Settings;
+			TArray<FSquirrelCellularResult> Results;
+			Results.SetNumUninitialized(Points.Num());
+
+			Runner.Time(TEXT("Cellular::Cellular2D"), NumPoints, [&Points, &Settings]
+			{
+				double Sum = 0.0;
+				for (const FVector2D& Point : Points)
+				{
+					Sum += Cellular::Cellular2D(Settings, Point, Seed).F1;
+				}
+				Consume(Sum);
+			});
+
+			Runner.Time(TEXT("Cellular::SampleCellular2D"), NumPoints,
+				[&Points, &Settings, &Results] { Cellular::SampleCellular2D(Settings, Seed, Points, Results); });
+		}
+
+		{
+			FSquirrelGrid2D Layout;
+			Layout.Size = FIntPoint(1024, FMath::Max(Num / 1024, 1));
+			Layout.Seed = Seed;
+			Uints.SetNumUninitialized(Layout.Num());
+
+			Runner.Time(TEXT("Grid::Fill2dNoiseUint"), Layout.Num(), [&Layout, &Uints] { Grid::Fill2dNoiseUint(Layout, Uints); });
+		}
+
+		{
+			// Sized to generate roughly NumPoints points.
+			FSquirrelPoissonDiskSettings Settings;
+			Settings.Radius = 10.0;
+			Settings.Seed = Seed;
+			const double Extent = FMath::Sqrt(static_cast<double>(NumPoints)) * Settings.Radius * 0.5;
+			const FBox2D Region(FVector2D(-Extent), FVector2D(Extent));
+
+			TArray<FVector2D> Scattered;
+			Scatter::PoissonDisk(Settings, Region, Scattered);
+
+			Runner.Time(TEXT("Scatter::PoissonDisk (per point)"), FMath::Max(Scattered.Num(), 1), [&Settings, &Region, &Scattered]
+			{
+				Scattered.Reset();
+				Scatter::PoissonDisk(Settings, Region, Scattered);
+			});
+		}
+	}
+
+	static void RunScaling(FRunner& Runner)
+	{
+		const int32 Num = Runner.Options.Iterations;
+		const int32 MaxThreads = Runner.Options.MaxThreads > 0
+			? Runner.Options.MaxThreads
+			: FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+		const TArray<FVector2D> Points = MakePoints(FMath::Max(Num / 8, 1), 1000.0);
+
+		FSquirrelFractalSettings Fractal;
+		Fractal.Octaves = 5;
+
+		UE_LOG(LogSquirrel, Display, TEXT("Scaling (%d threads at most):"), MaxThreads);
+
+		TArray<int32> ThreadCounts;
+		for (int32 Threads = 1; Threads < MaxThreads; Threads *= 2)
+		{
+			ThreadCounts.Add(Threads);
+		}
+		ThreadCounts.Add(MaxThreads);
+
+		// The same total work is split into one job per thread, so values/s should grow with the thread count.
+		for (const int32 Threads : ThreadCounts)
+		{
+			Runner.Time(FString::Printf(TEXT("Squirrel::Fill (uint32), %d threads"), Threads), Num, [Num, Threads]
+			{
+				ParallelFor(Threads, [Num, Threads](const int32 Job)
+				{
+					constexpr int32 BufferSize = 256;
+					uint32 Buffer[BufferSize];
+					uint32 Sum = 0;
+					FSquirrelState State{ Job };
+
+					for (int32 Remaining = Num / Threads; Remaining > 0; Remaining -= BufferSize)
+					{
+						Fill(State, MakeArrayView(Buffer, FMath::Min(Remaining, BufferSize)));
+						Sum += Buffer[0];
+					}
+					Consume(Sum);
+				}, EParallelForFlags::Unbalanced);
+			});
+
+			Runner.Time(FString::Printf(TEXT("Noise::Fractal2D, %d threads"), Threads), Points.Num(), [&Points, &Fractal, Threads]
+			{
+				ParallelFor(Threads, [&Points, &Fractal, Threads](const int32 Job)
+				{
+					const int32 PerJob = FMath::DivideAndRoundUp(Points.Num(), Threads);
+					const int32 End = FMath::Min(Points.Num(), (Job + 1) * PerJob);
+
+					double Sum = 0.0;
+					for (int32 i = Job * PerJob; i < End; ++i)
+					{
+						Sum += Noise::Fractal2D(Fractal, Points[i], Seed);
+					}
+					Consume(Sum);
+				}, EParallelForFlags::Unbalanced);
+			});
+		}
+	}
+
+	bool Run(const FOptions& InOptions)
+	{
+		FOptions Options = InOptions;
+		Options.Iterations = FMath::Max(Options.Iterations, 1024);
+
+		FSquirrelContext Context(Seed);
+		FSquirrelContextScope Scope(Context);
+
+		UE_LOG(LogSquirrel, Display, TEXT("Squirrel benchmark: %d iterations, SIMD: %s"), Options.Iterations, LexToString(Simd::GetInstructionSet()));
+
+		FRunner Runner(Options);
+		RunChecks(Runner);
+
+		if (!Options.bVerifyOnly)
+		{
+			RunTimings(Runner);
+			RunScaling(Runner);
+		}
+
+		if (Runner.Passed())
+		{
+			UE_LOG(LogSquirrel, Display, TEXT("All checks passed."));
+		}
+		else
+		{
+			UE_LOG(LogSquirrel, Error, TEXT("Some checks failed. Existing seeds may no longer generate what they used to."));
+		}
+
+		return Runner.Passed();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelCellularNoise.h"
+#include "SquirrelNoise5.hpp"
+#include "SquirrelNoise5Simd.h"
+#include "Async/ParallelFor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(SquirrelCellularNoise)
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The placement of feature points determines the
+ *	output of existing seeds.
+ */
+
+namespace Squirrel::Cellular
+{
+	// The per-axis multipliers Get2d/Get3dNoiseUint use to fold a cell coordinate into a single index.
+	static constexpr uint32 LatticePrimes[3] = { 1, Raw::PRIME1, Raw::PRIME2 };
+
+	// Number of points handed to each worker by the Sample functions.
+	static constexpr int32 BatchSize = 256;
+
+	template <int32 D>
+	static constexpr int32 NumNeighbours = D == 2 ? 9 : 27;
+
+	template <int32 D>
+	struct TNeighbourhood
+	{
+		// The offset of each neighbouring cell from the sample's cell, on each axis.
+		int32 Offsets[NumNeighbours<D>][D];
+
+		// The offset of each neighbouring cell, folded the same way as its coordinate.
+		uint32 FoldedOffsets[NumNeighbours<D>];
+
+		constexpr TNeighbourhood()
+		  : Offsets(), FoldedOffsets()
+		{
+			for (int32 n = 0; n < NumNeighbours<D>; ++n)
+			{
+				int32 Remaining = n;
+				FoldedOffsets[n] = 0;
+				for (int32 d = 0; d < D; ++d)
+				{
+					Offsets[n][d] = Remaining % 3 - 1;
+					Remaining /= 3;
+					FoldedOffsets[n] += static_cast<uint32>(Offsets[n][d]) * LatticePrimes[d];
+				}
+			}
+		}
+	};
+
+	template <int32 D>
+	static constexpr TNeighbourhood<D> Neighbourhood;
+
+	// Index of the sample's own cell in the neighbourhood.
+	template <int32 D>
+	static constexpr int32 CenterNeighbour = NumNeighbours<D> / 2;
+
+	/**
+	 * The position of a cell's feature point within the cell, from the cell's hash. The hash is split into one bitfield per
+	 * axis: 16 bits each in 2D, and 11/11/10 bits in 3D.
+	 */
+	template <int32 D>
+	static FORCEINLINE void FeatureOffset(const uint32 Hash, const double Jitter, double (&Out)[D])
+	{
+		if constexpr (D == 2)
+		{
+			Out[0] = (Hash & 0xFFFF) * (1.0 / 65536.0);
+			Out[1] = (Hash >> 16) * (1.0 / 65536.0);
+		}
+		else
+		{
+			Out[0] = (Hash & 0x7FF) * (1.0 / 2048.0);
+			Out[1] = ((Hash >> 11) & 0x7FF) * (1.0 / 2048.0);
+			Out[2] = (Hash >> 22) * (1.0 / 1024.0);
+		}
+
+		for (int32 d = 0; d < D; ++d)
+		{
+			Out[d] = 0.5 + (Out[d] - 0.5) * Jitter;
+		}
+	}
+
+	template <int32 D>
+	struct TPoint
+	{
+		double V[D];
+	};
+
+	static FORCEINLINE TPoint<2> ToPoint(const FVector2D& P) { return { { P.X, P.Y } }; }
+	static FORCEINLINE TPoint<3> ToPoint(const FVector& P) { return { { P.X, P.Y, P.Z } }; }
+
+	template <int32 D>
+	static FSquirrelCellularResult Search(const FSquirrelCellularSettings& Settings, const TPoint<D>& Point, const uint32 Seed)
+	{
+		static constexpr int32 N = NumNeighbours<D>;
+		const TNeighbourhood<D>& Cells = Neighbourhood<D>;
+
+		// Locate the sample's cell, and the sample's position inside of it.
+		double Frac[D];
+		uint32 Base = 0;
+		for (int32 d = 0; d < D; ++d)
+		{
+			const double Scaled = Point.V[d] * Settings.Frequency;
+			const double Floor = FMath::FloorToDouble(Scaled);
+			Frac[d] = Scaled - Floor;
+			Base += static_cast<uint32>(static_cast<int32>(Floor)) * LatticePrimes[d];
+		}
+
+		// Neighbours that need to be searched, compacted so that their hashes can be generated in a single batch.
+		int32 Candidates[N];
+		int32 Indices[N];
+		int32 NumCandidates = 0;
+
+		FSquirrelCellularResult Result;
+		double F1Sq = TNumericLimits<double>::Max();
+		double F2Sq = TNumericLimits<double>::Max();
+
+		if (Settings.bF1Only)
+		{
+			// Start with the sample's own cell, then only search neighbours that are closer than the best feature so far.
+			const uint32 Hash = Raw::SquirrelNoise5(static_cast<int32>(Base), Seed);
+
+			double Feature[D];
+			FeatureOffset<D>(Hash, Settings.Jitter, Feature);
+
+			F1Sq = 0.0;
+			for (int32 d = 0; d < D; ++d)
+			{
+				F1Sq += FMath::Square(Feature[d] - Frac[d]);
+			}
+			Result.CellId = Hash;
+
+			for (int32 n = 0; n < N; ++n)
+			{
+				if (n == CenterNeighbour<D>)
+				{
+					continue;
+				}
+
+				double NearestSq = 0.0;
+				for (int32 d = 0; d < D; ++d)
+				{
+					const int32 Offset = Cells.Offsets[n][d];
+					NearestSq += Offset < 0 ? FMath::Square(Frac[d]) : Offset > 0 ? FMath::Square(1.0 - Frac[d]) : 0.0;
+				}
+
+				if (NearestSq < F1Sq)
+				{
+					Candidates[NumCandidates] = n;
+					Indices[NumCandidates] = static_cast<int32>(Base + Cells.FoldedOffsets[n]);
+					NumCandidates++;
+				}
+			}
+		}
+		else
+		{
+			for (int32 n = 0; n < N; ++n)
+			{
+				Candidates[n] = n;
+				Indices[n] = static_cast<int32>(Base + Cells.FoldedOffsets[n]);
+			}
+			NumCandidates = N;
+		}
+
+		uint32 Hashes[N];
+		Simd::NoiseGather(Hashes, Indices, NumCandidates, Seed);
+
+		double DistancesSq[N];
+		for (int32 i = 0; i < NumCandidates; ++i)
+		{
+			double Feature[D];
+			FeatureOffset<D>(Hashes[i], Settings.Jitter, Feature);
+
+			double DistanceSq = 0.0;
+			for (int32 d = 0; d < D; ++d)
+			{
+				DistanceSq += FMath::Square(Cells.Offsets[Candidates[i]][d] + Feature[d] - Frac[d]);
+			}
+			DistancesSq[i] = DistanceSq;
+		}
+
+		for (int32 i = 0; i < NumCandidates; ++i)
+		{
+			if (DistancesSq[i] < F1Sq)
+			{
+				F2Sq = F1Sq;
+				F1Sq = DistancesSq[i];
+				Result.CellId = Hashes[i];
+			}
+			else if (DistancesSq[i] < F2Sq)
+			{
+				F2Sq = DistancesSq[i];
+			}
+		}
+
+		Result.F1 = FMath::Sqrt(F1Sq);
+		Result.F2 = Settings.bF1Only ? TNumericLimits<double>::Max() : FMath::Sqrt(F2Sq);
+		return Result;
+	}
+
+	template <int32 D, typename FGetPoint>
+	static void Sample(const FSquirrelCellularSettings& Settings, const uint32 Seed, const int32 Num, FGetPoint&& GetPoint, const TArrayView<FSquirrelCellularResult> Out)
+	{
+		check(Out.Num() == Num);
+		SQUIRREL_TRACE_BATCH(SampleCellular, Num);
+		SQUIRREL_COUNT(CellularSamples, Num);
+
+		ParallelFor(FMath::DivideAndRoundUp(Num, BatchSize),
+			[&](const int32 BatchIndex)
+			{
+				const int32 Start = BatchIndex * BatchSize;
+				const int32 End = FMath::Min(Start + BatchSize, Num);
+
+				for (int32 i = Start; i < End; ++i)
+				{
+					Out[i] = Search<D>(Settings, GetPoint(i), Seed);
+				}
+			});
+	}
+
+	FSquirrelCellularResult Cellular2D(const FSquirrelCellularSettings& Settings, const FVector2D& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(CellularSamples, 1);
+		return Search<2>(Settings, ToPoint(Point), Seed);
+	}
+
+	FSquirrelCellularResult Cellular3D(const FSquirrelCellularSettings& Settings, const FVector& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(CellularSamples, 1);
+		return Search<3>(Settings, ToPoint(Point), Seed);
+	}
+
+	void SampleCellular2D(const FSquirrelCellularSettings& Settings, const uint32 Seed, const TConstArrayView<FVector2D> Points, const TArrayView<FSquirrelCellularResult> Out)
+	{
+		Sample<2>(Settings, Seed, Points.Num(), [&Points](const int32 i) { return ToPoint(Points[i]); }, Out);
+	}
+
+	void SampleCellular3D(const FSquirrelCellularSettings& Settings, const uint32 Seed, const TConstArrayView<FVector> Points, const TArrayView<FSquirrelCellularResult> Out)
+	{
+		Sample<3>(Settings, Seed, Points.Num(), [&Points](const int32 i) { return ToPoint(Points[i]); }, Out);
+	}
+
+	void SampleCellularGrid2D(const FSquirrelCellularSettings& Settings, const uint32 Seed,
+		const FVector2D& Origin, const FVector2D& Spacing, const FIntPoint Size, const TArrayView<FSquirrelCellularResult> Out)
+	{
+		Sample<2>(Settings, Seed, Size.X * Size.Y,
+			[&](const int32 i)
+			{
+				return ToPoint(Origin + Spacing * FVector2D(i % Size.X, i / Size.X));
+			},
+			Out);
+	}
+
+	void SampleCellularGrid3D(const FSquirrelCellularSettings& Settings, const uint32 Seed,
+		const FVector& Origin, const FVector& Spacing, const FIntVector Size, const TArrayView<FSquirrelCellularResult> Out)
+	{
+		const int32 Slice = Size.X * Size.Y;
+
+		Sample<3>(Settings, Seed, Slice * Size.Z,
+			[&](const int32 i)
+			{
+				return ToPoint(Origin + Spacing * FVector(i % Size.X, (i % Slice) / Size.X, i / Slice));
+			},
+			Out);
+	}
+}
@@ -0,0 +1,551 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelCoherentNoise.h"
+#include "SquirrelNoiseBatch.h"
+#include "SquirrelNoise5.hpp"
+#include "SquirrelNoise5Simd.h"
+#include "Async/ParallelFor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(SquirrelCoherentNoise)
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The lattice hashing, gradient tables, and octave
+ *	seeding here determine the output of existing seeds.
+ */
+
+namespace Squirrel::Noise
+{
+	// The per-axis multipliers Get1d-Get4dNoiseUint use to fold a lattice coordinate into a single index.
+	static constexpr uint32 LatticePrimes[4] = { 1, Raw::PRIME1, Raw::PRIME2, Raw::PRIME3 };
+
+	// Number of points whose lattice hashes are generated together by the Sample functions.
+	static constexpr int32 BatchSize = 128;
+
+	static constexpr int32 MaxOctaves = 16;
+
+	// Rescales gradient noise of each dimension to approximately [-1,1].
+	static constexpr double GradientScale[4] = { 2.0, UE_DOUBLE_SQRT_2, 1.0, 0.8 };
+
+	static constexpr double Gradients2D[8][2] =
+	{
+		{ 1.0, 0.0 }, { -1.0, 0.0 }, { 0.0, 1.0 }, { 0.0, -1.0 },
+		{ UE_DOUBLE_INV_SQRT_2, UE_DOUBLE_INV_SQRT_2 }, { -UE_DOUBLE_INV_SQRT_2, UE_DOUBLE_INV_SQRT_2 },
+		{ UE_DOUBLE_INV_SQRT_2, -UE_DOUBLE_INV_SQRT_2 }, { -UE_DOUBLE_INV_SQRT_2, -UE_DOUBLE_INV_SQRT_2 }
+	};
+
+	static constexpr double Gradients3D[12][3] =
+	{
+		{ 1.0, 1.0, 0.0 }, { -1.0, 1.0, 0.0 }, { 1.0, -1.0, 0.0 }, { -1.0, -1.0, 0.0 },
+		{ 1.0, 0.0, 1.0 }, { -1.0, 0.0, 1.0 }, { 1.0, 0.0, -1.0 }, { -1.0, 0.0, -1.0 },
+		{ 0.0, 1.0, 1.0 }, { 0.0, -1.0, 1.0 }, { 0.0, 1.0, -1.0 }, { 0.0, -1.0, -1.0 }
+	};
+
+	static constexpr double Gradients4D[32][4] =
+	{
+		{ 0.0, 1.0, 1.0, 1.0 }, { 0.0, 1.0, 1.0, -1.0 }, { 0.0, 1.0, -1.0, 1.0 }, { 0.0, 1.0, -1.0, -1.0 },
+		{ 0.0, -1.0, 1.0, 1.0 }, { 0.0, -1.0, 1.0, -1.0 }, { 0.0, -1.0, -1.0, 1.0 }, { 0.0, -1.0, -1.0, -1.0 },
+		{ 1.0, 0.0, 1.0, 1.0 }, { 1.0, 0.0, 1.0, -1.0 }, { 1.0, 0.0, -1.0, 1.0 }, { 1.0, 0.0, -1.0, -1.0 },
+		{ -1.0, 0.0, 1.0, 1.0 }, { -1.0, 0.0, 1.0, -1.0 }, { -1.0, 0.0, -1.0, 1.0 }, { -1.0, 0.0, -1.0, -1.0 },
+		{ 1.0, 1.0, 0.0, 1.0 }, { 1.0, 1.0, 0.0, -1.0 }, { 1.0, -1.0, 0.0, 1.0 }, { 1.0, -1.0, 0.0, -1.0 },
+		{ -1.0, 1.0, 0.0, 1.0 }, { -1.0, 1.0, 0.0, -1.0 }, { -1.0, -1.0, 0.0, 1.0 }, { -1.0, -1.0, 0.0, -1.0 },
+		{ 1.0, 1.0, 1.0, 0.0 }, { 1.0, 1.0, -1.0, 0.0 }, { 1.0, -1.0, 1.0, 0.0 }, { 1.0, -1.0, -1.0, 0.0 },
+		{ -1.0, 1.0, 1.0, 0.0 }, { -1.0, 1.0, -1.0, 0.0 }, { -1.0, -1.0, 1.0, 0.0 }, { -1.0, -1.0, -1.0, 0.0 }
+	};
+
+	template <int32 D>
+	struct TPoint
+	{
+		double V[D];
+	};
+
+	static FORCEINLINE TPoint<1> ToPoint(const double X) { return { { X } }; }
+	static FORCEINLINE TPoint<2> ToPoint(const FVector2D& P) { return { { P.X, P.Y } }; }
+	static FORCEINLINE TPoint<3> ToPoint(const FVector& P) { return { { P.X, P.Y, P.Z } }; }
+	static FORCEINLINE TPoint<4> ToPoint(const FVector4& P) { return { { P.X, P.Y, P.Z, P.W } }; }
+
+	// Quintic smoothstep, for C2 continuous interpolation between lattice points.
+	static FORCEINLINE double Fade(const double T)
+	{
+		return T * T * T * (T * (T * 6.0 - 15.0) + 10.0);
+	}
+
+	// Map a hash uniformly onto [0, Count).
+	static FORCEINLINE uint32 Pick(const uint32 Hash, const uint32 Count)
+	{
+		return static_cast<uint32>((static_cast<uint64>(Hash) * Count) >> 32);
+	}
+
+	/**
+	 * Finds the lattice cell containing Point. Returns the folded index of the cell's lowest corner, and writes the
+	 * position of Point inside of the cell to Frac.
+	 */
+	template <int32 D>
+	static FORCEINLINE uint32 LocateCell(const TPoint<D>& Point, double (&Frac)[D])
+	{
+		uint32 Base = 0;
+		for (int32 d = 0; d < D; ++d)
+		{
+			const double Floor = FMath::FloorToDouble(Point.V[d]);
+			Frac[d] = Point.V[d] - Floor;
+			Base += static_cast<uint32>(static_cast<int32>(Floor)) * LatticePrimes[d];
+		}
+		return Base;
+	}
+
+	// The folded index of a corner of a cell. Bit d of Corner selects the upper side of the cell along axis d.
+	template <int32 D>
+	static FORCEINLINE int32 CornerIndex(const uint32 Base, const int32 Corner)
+	{
+		uint32 Index = Base;
+		for (int32 d = 0; d < D; ++d)
+		{
+			if (Corner & (1 << d))
+			{
+				Index += LatticePrimes[d];
+			}
+		}
+		return static_cast<int32>(Index);
+	}
+
+	template <int32 D>
+	static FORCEINLINE double GradientDot(const uint32 Hash, const double (&Offset)[D])
+	{
+		if constexpr (D == 1)
+		{
+			return Raw::ONE_OVER_MAX_INT * static_cast<double>(static_cast<int32>(Hash)) * Offset[0];
+		}
+		else if constexpr (D == 2)
+		{
+			const double* G = Gradients2D[Pick(Hash, 8)];
+			return G[0] * Offset[0] + G[1] * Offset[1];
+		}
+		else if constexpr (D == 3)
+		{
+			const double* G = Gradients3D[Pick(Hash, 12)];
+			return G[0] * Offset[0] + G[1] * Offset[1] + G[2] * Offset[2];
+		}
+		else
+		{
+			const double* G = Gradients4D[Pick(Hash, 32)];
+			return G[0] * Offset[0] + G[1] * Offset[1] + G[2] * Offset[2] + G[3] * Offset[3];
+		}
+	}
+
+	// Interpolates the 2^D corner values of a cell down to a single value, collapsing one axis at a time.
+	template <int32 D>
+	static FORCEINLINE double Collapse(double (&Values)[1 << D], const double (&Frac)[D])
+	{
+		for (int32 d = 0; d < D; ++d)
+		{
+			const double T = Fade(Frac[d]);
+			const int32 Count = 1 << (D - d - 1);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Values[i] = FMath::Lerp(Values[i * 2], Values[i * 2 + 1], T);
+			}
+		}
+		return Values[0];
+	}
+
+	// Evaluates one cell of noise from its corner hashes.
+	template <ESquirrelNoiseBasis Basis, int32 D>
+	static FORCEINLINE double EvaluateCell(const uint32* Hashes, const double (&Frac)[D])
+	{
+		double Values[1 << D];
+
+		for (int32 Corner = 0; Corner < (1 << D); ++Corner)
+		{
+			if constexpr (Basis == ESquirrelNoiseBasis::Value)
+			{
+				Values[Corner] = Raw::ONE_OVER_MAX_INT * static_cast<double>(static_cast<int32>(Hashes[Corner]));
+			}
+			else
+			{
+				double Offset[D];
+				for (int32 d = 0; d < D; ++d)
+				{
+					Offset[d] = Frac[d] - ((Corner >> d) & 1);
+				}
+				Values[Corner] = GradientDot<D>(Hashes[Corner], Offset);
+			}
+		}
+
+		if constexpr (Basis == ESquirrelNoiseBasis::Value)
+		{
+			return Collapse<D>(Values, Frac);
+		}
+		else
+		{
+			return Collapse<D>(Values, Frac) * GradientScale[D - 1];
+		}
+	}
+
+	template <ESquirrelNoiseBasis Basis, int32 D>
+	static double Evaluate(const TPoint<D>& Point, const uint32 Seed)
+	{
+		double Frac[D];
+		const uint32 Base = LocateCell<D>(Point, Frac);
+
+		uint32 Hashes[1 << D];
+		for (int32 Corner = 0; Corner < (1 << D); ++Corner)
+		{
+			Hashes[Corner] = Raw::Get1dNoiseUint(CornerIndex<D>(Base, Corner), Seed);
+		}
+
+		return EvaluateCell<Basis, D>(Hashes, Frac);
+	}
+
+	/*
+	 * Fractal octave combination
+	 */
+
+	struct FOctaves
+	{
+		int32 Num = 0;
+		uint32 Seeds[MaxOctaves];
+		double Frequencies[MaxOctaves];
+		double Amplitudes[MaxOctaves];
+		double Normalization = 1.0;
+
+		FOctaves(const FSquirrelFractalSettings& Settings, const uint32 Seed)
+		  : Num(FMath::Clamp(Settings.Octaves, 1, MaxOctaves))
+		{
+			double Frequency = Settings.Frequency;
+			double Amplitude = 1.0;
+			double AmplitudeSum = 0.0;
+
+			for (int32 Octave = 0; Octave < Num; ++Octave)
+			{
+				Seeds[Octave] = Raw::Get1dNoiseUint(Octave, Seed);
+				Frequencies[Octave] = Frequency;
+				Amplitudes[Octave] = Amplitude;
+				AmplitudeSum += Amplitude;
+
+				Frequency *= Settings.Lacunarity;
+				Amplitude *= Settings.Gain;
+			}
+
+			Normalization = AmplitudeSum > 0.0 ? 1.0 / AmplitudeSum : 0.0;
+		}
+	};
+
+	template <ESquirrelFractalType Type>
+	static FORCEINLINE double Accumulate(const double Noise)
+	{
+		if constexpr (Type == ESquirrelFractalType::FBm)
+		{
+			return Noise;
+		}
+		else if constexpr (Type == ESquirrelFractalType::Ridged)
+		{
+			const double Ridge = 1.0 - FMath::Abs(Noise);
+			return Ridge * Ridge;
+		}
+		else
+		{
+			return FMath::Abs(Noise);
+		}
+	}
+
+	template <ESquirrelNoiseBasis Basis, ESquirrelFractalType Type, int32 D>
+	static double EvaluateFractal(const FOctaves& Octaves, const TPoint<D>& Point)
+	{
+		double Sum = 0.0;
+
+		for (int32 Octave = 0; Octave < Octaves.Num; ++Octave)
+		{
+			TPoint<D> Scaled;
+			for (int32 d = 0; d < D; ++d)
+			{
+				Scaled.V[d] = Point.V[d] * Octaves.Frequencies[Octave];
+			}
+
+			Sum += Accumulate<Type>(Evaluate<Basis, D>(Scaled, Octaves.Seeds[Octave])) * Octaves.Amplitudes[Octave];
+		}
+
+		return Sum * Octaves.Normalization;
+	}
+
+	/**
+	 * Evaluates a fractal for a batch of points, one octave at a time. The corner indices of every point are gathered
+	 * first so that all of the octave's lattice hashes can be generated together by the SIMD kernels.
+	 */
+	template <ESquirrelNoiseBasis Basis, ESquirrelFractalType Type, int32 D>
+	static void EvaluateFractalBatch(const FOctaves& Octaves, const TPoint<D>* Points, const int32 Num, double* Out)
+	{
+		static constexpr int32 Corners = 1 << D;
+
+		check(Num <= BatchSize);
+
+		double Frac[BatchSize][D];
+		int32 Indices[BatchSize * Corners];
+		uint32 Hashes[BatchSize * Corners];
+
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Out[i] = 0.0;
+		}
+
+		for (int32 Octave = 0; Octave < Octaves.Num; ++Octave)
+		{
+			const double Frequency = Octaves.Frequencies[Octave];
+
+			for (int32 i = 0; i < Num; ++i)
+			{
+				TPoint<D> Scaled;
+				for (int32 d = 0; d < D; ++d)
+				{
+					Scaled.V[d] = Points[i].V[d] * Frequency;
+				}
+
+				const uint32 Base = LocateCell<D>(Scaled, Frac[i]);
+				for (int32 Corner = 0; Corner < Corners; ++Corner)
+				{
+					Indices[i * Corners + Corner] = CornerIndex<D>(Base, Corner);
+				}
+			}
+
+			Simd::NoiseGather(Hashes, Indices, Num * Corners, Octaves.Seeds[Octave]);
+
+			const double Amplitude = Octaves.Amplitudes[Octave];
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Out[i] += Accumulate<Type>(EvaluateCell<Basis, D>(Hashes + i * Corners, Frac[i])) * Amplitude;
+			}
+		}
+
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Out[i] *= Octaves.Normalization;
+		}
+	}
+
+	/*
+	 * Dispatch from runtime settings to the templated implementations.
+	 */
+
+	template <int32 D, typename FFunc>
+	static decltype(auto) Dispatch(const FSquirrelFractalSettings& Settings, FFunc&& Func)
+	{
+		const bool bValue = Settings.Basis == ESquirrelNoiseBasis::Value;
+
+		switch (Settings.Type)
+		{
+		case ESquirrelFractalType::Ridged:
+			return bValue
+				? Func.template operator()<ESquirrelNoiseBasis::Value, ESquirrelFractalType::Ridged>()
+				: Func.template operator()<ESquirrelNoiseBasis::Gradient, ESquirrelFractalType::Ridged>();
+		case ESquirrelFractalType::Turbulence:
+			return bValue
+				? Func.template operator()<ESquirrelNoiseBasis::Value, ESquirrelFractalType::Turbulence>()
+				: Func.template operator()<ESquirrelNoiseBasis::Gradient, ESquirrelFractalType::Turbulence>();
+		default:
+			return bValue
+				? Func.template operator()<ESquirrelNoiseBasis::Value, ESquirrelFractalType::FBm>()
+				: Func.template operator()<ESquirrelNoiseBasis::Gradient, ESquirrelFractalType::FBm>();
+		}
+	}
+
+	template <int32 D>
+	static double Fractal(const FSquirrelFractalSettings& Settings, const TPoint<D>& Point, const uint32 Seed)
+	{
+		const FOctaves Octaves(Settings, Seed);
+
+		return Dispatch<D>(Settings,
+			[&]<ESquirrelNoiseBasis Basis, ESquirrelFractalType Type>()
+			{
+				return EvaluateFractal<Basis, Type, D>(Octaves, Point);
+			});
+	}
+
+	/**
+	 * Samples a fractal for Num points in parallel batches. GetPoint(Index) must return the point to sample for Out[Index].
+	 */
+	template <int32 D, typename FGetPoint>
+	static void SampleFractal(const FSquirrelFractalSettings& Settings, const uint32 Seed, const int32 Num, FGetPoint&& GetPoint, const TArrayView<double> Out)
+	{
+		check(Out.Num() == Num);
+		SQUIRREL_TRACE_BATCH(SampleFractal, Num);
+		SQUIRREL_COUNT(NoiseSamples, Num);
+
+		const FOctaves Octaves(Settings, Seed);
+
+		Dispatch<D>(Settings,
+			[&]<ESquirrelNoiseBasis Basis, ESquirrelFractalType Type>()
+			{
+				ParallelFor(FMath::DivideAndRoundUp(Num, BatchSize),
+					[&](const int32 BatchIndex)
+					{
+						const int32 Start = BatchIndex * BatchSize;
+						const int32 Count = FMath::Min(BatchSize, Num - Start);
+
+						TPoint<D> Points[BatchSize];
+						for (int32 i = 0; i < Count; ++i)
+						{
+							Points[i] = GetPoint(Start + i);
+						}
+
+						EvaluateFractalBatch<Basis, Type, D>(Octaves, Points, Count, Out.GetData() + Start);
+					});
+			});
+	}
+
+	namespace Batch
+	{
+		template <int32 D>
+		static void Fractal(const FSquirrelFractalSettings& Settings, const uint32 Seed, const FVector* Points, const int32 Num, double* Out)
+		{
+			SQUIRREL_COUNT(NoiseSamples, Num);
+
+			const FOctaves Octaves(Settings, Seed);
+
+			Dispatch<D>(Settings,
+				[&]<ESquirrelNoiseBasis Basis, ESquirrelFractalType Type>()
+				{
+					for (int32 Start = 0; Start < Num; Start += BatchSize)
+					{
+						const int32 Count = FMath::Min(BatchSize, Num - Start);
+
+						TPoint<D> Batch[BatchSize];
+						for (int32 i = 0; i < Count; ++i)
+						{
+							for (int32 d = 0; d < D; ++d)
+							{
+								Batch[i].V[d] = Points[Start + i][d];
+							}
+						}
+
+						EvaluateFractalBatch<Basis, Type, D>(Octaves, Batch, Count, Out + Start);
+					}
+				});
+		}
+
+		void Fractal2D(const FSquirrelFractalSettings& Settings, const uint32 Seed, const FVector* Points, const int32 Num, double* Out)
+		{
+			Fractal<2>(Settings, Seed, Points, Num, Out);
+		}
+
+		void Fractal3D(const FSquirrelFractalSettings& Settings, const uint32 Seed, const FVector* Points, const int32 Num, double* Out)
+		{
+			Fractal<3>(Settings, Seed, Points, Num, Out);
+		}
+	}
+
+	double Value1D(const double X, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Value, 1>(ToPoint(X), Seed);
+	}
+
+	double Value2D(const FVector2D& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Value, 2>(ToPoint(Point), Seed);
+	}
+
+	double Value3D(const FVector& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Value, 3>(ToPoint(Point), Seed);
+	}
+
+	double Value4D(const FVector4& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Value, 4>(ToPoint(Point), Seed);
+	}
+
+	double Gradient1D(const double X, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Gradient, 1>(ToPoint(X), Seed);
+	}
+
+	double Gradient2D(const FVector2D& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Gradient, 2>(ToPoint(Point), Seed);
+	}
+
+	double Gradient3D(const FVector& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Gradient, 3>(ToPoint(Point), Seed);
+	}
+
+	double Gradient4D(const FVector4& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Evaluate<ESquirrelNoiseBasis::Gradient, 4>(ToPoint(Point), Seed);
+	}
+
+	double Fractal1D(const FSquirrelFractalSettings& Settings, const double X, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Fractal<1>(Settings, ToPoint(X), Seed);
+	}
+
+	double Fractal2D(const FSquirrelFractalSettings& Settings, const FVector2D& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Fractal<2>(Settings, ToPoint(Point), Seed);
+	}
+
+	double Fractal3D(const FSquirrelFractalSettings& Settings, const FVector& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Fractal<3>(Settings, ToPoint(Point), Seed);
+	}
+
+	double Fractal4D(const FSquirrelFractalSettings& Settings, const FVector4& Point, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(NoiseSamples, 1);
+		return Fractal<4>(Settings, ToPoint(Point), Seed);
+	}
+
+	void SampleFractal1D(const FSquirrelFractalSettings& Settings, const uint32 Seed, const TConstArrayView<double> Points, const TArrayView<double> Out)
+	{
+		SampleFractal<1>(Settings, Seed, Points.Num(), [&Points](const int32 i) { return ToPoint(Points[i]); }, Out);
+	}
+
+	void SampleFractal2D(const FSquirrelFractalSettings& Settings, const uint32 Seed, const TConstArrayView<FVector2D> Points, const TArrayView<double> Out)
+	{
+		SampleFractal<2>(Settings, Seed, Points.Num(), [&Points](const int32 i) { return ToPoint(Points[i]); }, Out);
+	}
+
+	void SampleFractal3D(const FSquirrelFractalSettings& Settings, const uint32 Seed, const TConstArrayView<FVector> Points, const TArrayView<double> Out)
+	{
+		SampleFractal<3>(Settings, Seed, Points.Num(), [&Points](const int32 i) { return ToPoint(Points[i]); }, Out);
+	}
+
+	void SampleFractal4D(const FSquirrelFractalSettings& Settings, const uint32 Seed, const TConstArrayView<FVector4> Points, const TArrayView<double> Out)
+	{
+		SampleFractal<4>(Settings, Seed, Points.Num(), [&Points](const int32 i) { return ToPoint(Points[i]); }, Out);
+	}
+
+	void SampleFractalGrid2D(const FSquirrelFractalSettings& Settings, const uint32 Seed,
+		const FVector2D& Origin, const FVector2D& Spacing, const FIntPoint Size, const TArrayView<double> Out)
+	{
+		SampleFractal<2>(Settings, Seed, Size.X * Size.Y,
+			[&](const int32 i)
+			{
+				return ToPoint(Origin + Spacing * FVector2D(i % Size.X, i / Size.X));
+			},
+			Out);
+	}
+
+	void SampleFractalGrid3D(const FSquirrelFractalSettings& Settings, const uint32 Seed,
+		const FVector& Origin, const FVector& Spacing, const FIntVector Size, const TArrayView<double> Out)
+	{
+		const int32 Slice = Size.X * Size.Y;
+
+		SampleFractal<3>(Settings, Seed, Slice * Size.Z,
+			[&](const int32 i)
+			{
+				return ToPoint(Origin + Spacing * FVector(i % Size.X, (i % Slice) / Size.X, i / Slice));
+			},
+			Out);
+	}
+}
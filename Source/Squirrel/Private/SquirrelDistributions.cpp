@@ -0,0 +1,546 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelDistributions.h"
+#include "SquirrelNoise5.hpp"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The ziggurat tables, the rejection methods, and
+ *	the way noise is drawn for each sample determine
+ *	the output of existing seeds.
+ */
+
+namespace Squirrel::Distributions
+{
+	// constexpr replacements for the C library functions, so that the tables can be built at compile time, and so that
+	// rejection tests give the same answers on every platform.
+	namespace Math
+	{
+		static constexpr double Ln2 = 0.69314718055994530942;
+		static constexpr double HalfLog2Pi = 0.91893853320467274178;
+
+		constexpr double Exp(const double X)
+		{
+			if (X < -745.0)
+			{
+				return 0.0;
+			}
+
+			// Reduce to X = K * ln(2) + R, where |R| <= ln(2) / 2, and sum the Taylor series of R.
+			const int32 K = static_cast<int32>(X / Ln2 + (X < 0.0 ? -0.5 : 0.5));
+			const double R = X - K * Ln2;
+
+			double Term = 1.0;
+			double Sum = 1.0;
+			for (int32 i = 1; i < 20; ++i)
+			{
+				Term *= R / i;
+				Sum += Term;
+			}
+
+			for (int32 i = 0; i < K; ++i)
+			{
+				Sum *= 2.0;
+			}
+			for (int32 i = 0; i > K; --i)
+			{
+				Sum *= 0.5;
+			}
+
+			return Sum;
+		}
+
+		// X must be above 0.
+		constexpr double Log(const double X)
+		{
+			// Reduce to X = M * 2^E, where M is in [0.5, 1), and sum the series of ln(M) = 2 * atanh((M - 1) / (M + 1)).
+			int32 E = 0;
+			double M = X;
+			while (M >= 1.0)
+			{
+				M *= 0.5;
+				++E;
+			}
+			while (M < 0.5)
+			{
+				M *= 2.0;
+				--E;
+			}
+
+			const double Z = (M - 1.0) / (M + 1.0);
+			const double Z2 = Z * Z;
+
+			double Term = Z;
+			double Sum = 0.0;
+			for (int32 i = 1; i < 40; i += 2)
+			{
+				Sum += Term / i;
+				Term *= Z2;
+			}
+
+			return 2.0 * Sum + E * Ln2;
+		}
+
+		constexpr double Floor(const double X)
+		{
+			const double Int = static_cast<double>(static_cast<int64>(X));
+			return X < Int ? Int - 1.0 : Int;
+		}
+
+		// Only used to build the tables. At runtime, the correctly rounded FMath::Sqrt is already the same everywhere.
+		constexpr double Sqrt(const double X)
+		{
+			if (X <= 0.0)
+			{
+				return 0.0;
+			}
+
+			double Root = X > 1.0 ? X : 1.0;
+			for (int32 i = 0; i < 100; ++i)
+			{
+				const double Next = 0.5 * (Root + X / Root);
+				if (Next == Root)
+				{
+					break;
+				}
+				Root = Next;
+			}
+			return Root;
+		}
+
+		// ln(Gamma(X)) for X >= 1, by Stirling's series, after shifting X up to where the series is accurate.
+		constexpr double LogGamma(double X)
+		{
+			double Product = 1.0;
+			while (X < 10.0)
+			{
+				Product *= X;
+				X += 1.0;
+			}
+
+			const double Inv = 1.0 / X;
+			const double Inv2 = Inv * Inv;
+			const double Series = Inv * (1.0 / 12.0 - Inv2 * (1.0 / 360.0 - Inv2 * (1.0 / 1260.0 - Inv2 * (1.0 / 1680.0))));
+			return (X - 0.5) * Log(X) - X + HalfLog2Pi + Series - Log(Product);
+		}
+	}
+
+	/**
+	 * Layer boundaries of a ziggurat of N layers of equal area V under a decreasing density F. X[0] is the width of the base
+	 * layer's box (V / F(R)), X[1] is R, the start of the tail, and X[N] is 0. F[i] is the density at X[i].
+	 */
+	template <int32 N>
+	struct TZigguratTable
+	{
+		double X[N + 1] = {};
+		double F[N + 1] = {};
+	};
+
+	// Marsaglia and Tsang's constants for 128 layers of exp(-x^2 / 2).
+	static constexpr int32 NormalLayers = 128;
+	static constexpr double NormalR = 3.442619855899;
+	static constexpr double NormalV = 9.91256303526217e-3;
+
+	// Marsaglia and Tsang's constants for 256 layers of exp(-x).
+	static constexpr int32 ExponentialLayers = 256;
+	static constexpr double ExponentialR = 7.69711747013104972;
+	static constexpr double ExponentialV = 3.949659822581572e-3;
+
+	constexpr double NormalDensity(const double X) { return Math::Exp(-0.5 * X * X); }
+	constexpr double NormalInverse(const double Y) { return Math::Sqrt(-2.0 * Math::Log(Y)); }
+
+	constexpr double ExponentialDensity(const double X) { return Math::Exp(-X); }
+	constexpr double ExponentialInverse(const double Y) { return -Math::Log(Y); }
+
+	template <int32 N, typename DensityType, typename InverseType>
+	constexpr TZigguratTable<N> MakeZigguratTable(const double R, const double V, DensityType Density, InverseType Inverse)
+	{
+		TZigguratTable<N> Table;
+		Table.X[0] = V / Density(R);
+		Table.X[1] = R;
+
+		// Each layer's top is where the box of area V on top of the previous one meets the curve.
+		for (int32 i = 1; i < N - 1; ++i)
+		{
+			Table.X[i + 1] = Inverse(V / Table.X[i] + Density(Table.X[i]));
+		}
+		Table.X[N] = 0.0;
+
+		for (int32 i = 0; i <= N; ++i)
+		{
+			Table.F[i] = Density(Table.X[i]);
+		}
+
+		return Table;
+	}
+
+	static constexpr TZigguratTable<NormalLayers> NormalTable =
+		MakeZigguratTable<NormalLayers>(NormalR, NormalV, NormalDensity, NormalInverse);
+
+	static constexpr TZigguratTable<ExponentialLayers> ExponentialTable =
+		MakeZigguratTable<ExponentialLayers>(ExponentialR, ExponentialV, ExponentialDensity, ExponentialInverse);
+
+	// The constants are only consistent if the top layer closes in on 0.
+	static_assert(NormalTable.X[NormalLayers - 1] > 0.0 && NormalTable.X[NormalLayers - 1] < 0.3);
+	static_assert(ExponentialTable.X[ExponentialLayers - 1] > 0.0 && ExponentialTable.X[ExponentialLayers - 1] < 0.1);
+
+	/**
+	 * The noise for a single sample. The first value is the noise of the sample's position, as Next<uint32> would return.
+	 * Any further values, only needed when a sample is rejected, are hashed from the same position under derived seeds.
+	 */
+	class FSampleNoise
+	{
+	public:
+		FSampleNoise(const int32 InPosition, const uint32 InSeed, const uint32 InFirst)
+		  : Position(InPosition),
+			Seed(InSeed),
+			First(InFirst)
+		{
+		}
+
+		explicit FSampleNoise(FSquirrelState& State)
+		  : Position(State.Position),
+			Seed(GetGlobalSeed()),
+			First(Next<uint32>(State))
+		{
+			SQUIRREL_COUNT(DistributionSamples, 1);
+		}
+
+		uint32 NextUint()
+		{
+			if (Drawn++ == 0)
+			{
+				return First;
+			}
+
+			// Salted, so that the derived seeds are unlike the seeds of Split and the per-octave seeds of the noise functions.
+			return Raw::SquirrelNoise5(Position, Raw::SquirrelNoise5(Drawn, Seed ^ 0x6A09E667));
+		}
+
+		// A value in (0, 1), never 0, so that it is always safe to take its log.
+		double NextUniform()
+		{
+			return (static_cast<double>(NextUint()) + 0.5) * (1.0 / 4294967296.0);
+		}
+
+	private:
+		const int32 Position;
+		const uint32 Seed;
+		const uint32 First;
+		int32 Drawn = 0;
+	};
+
+	// 24 bits of a value, as a fraction in [0, 1).
+	static constexpr double OneOver2To24 = 1.0 / 16777216.0;
+
+	static double SampleNormal(FSampleNoise& Noise)
+	{
+		for (;;)
+		{
+			// The low 7 bits pick the layer, the next the sign, and the top 24 the position along the layer.
+			const uint32 Bits = Noise.NextUint();
+			const int32 Layer = Bits & (NormalLayers - 1);
+			const bool bNegative = !!(Bits & NormalLayers);
+			const double X = static_cast<double>(Bits >> 8) * OneOver2To24 * NormalTable.X[Layer];
+
+			// Inside the part of the layer that lies entirely under the curve, which is by far the most likely.
+			if (X < NormalTable.X[Layer + 1])
+			{
+				return bNegative ? -X : X;
+			}
+
+			if (Layer == 0)
+			{
+				// Marsaglia's method for the tail beyond R.
+				double TailX;
+				double TailY;
+				do
+				{
+					TailX = -Math::Log(Noise.NextUniform()) / NormalR;
+					TailY = -Math::Log(Noise.NextUniform());
+				}
+				while (TailY + TailY < TailX * TailX);
+
+				return bNegative ? -(NormalR + TailX) : NormalR + TailX;
+			}
+
+			const double Y = NormalTable.F[Layer] + Noise.NextUniform() * (NormalTable.F[Layer + 1] - NormalTable.F[Layer]);
+			if (Y < NormalDensity(X))
+			{
+				return bNegative ? -X : X;
+			}
+		}
+	}
+
+	static double SampleExponential(FSampleNoise& Noise)
+	{
+		for (;;)
+		{
+			// The low 8 bits pick the layer, and the top 24 the position along the layer.
+			const uint32 Bits = Noise.NextUint();
+			const int32 Layer = Bits & (ExponentialLayers - 1);
+			const double X = static_cast<double>(Bits >> 8) * OneOver2To24 * ExponentialTable.X[Layer];
+
+			if (X < ExponentialTable.X[Layer + 1])
+			{
+				return X;
+			}
+
+			if (Layer == 0)
+			{
+				// The exponential distribution is memoryless, so the tail is just another exponential beyond R.
+				return ExponentialR - Math::Log(Noise.NextUniform());
+			}
+
+			const double Y = ExponentialTable.F[Layer] + Noise.NextUniform() * (ExponentialTable.F[Layer + 1] - ExponentialTable.F[Layer]);
+			if (Y < ExponentialDensity(X))
+			{
+				return X;
+			}
+		}
+	}
+
+	static int32 SamplePoisson(FSampleNoise& Noise, const double Mean)
+	{
+		if (!(Mean > 0.0))
+		{
+			return 0;
+		}
+
+		if (Mean < 10.0)
+		{
+			// Count uniforms until their product drops below exp(-Mean).
+			const double Limit = Math::Exp(-Mean);
+			int32 Count = 0;
+			double Product = Noise.NextUniform();
+			while (Product > Limit)
+			{
+				++Count;
+				Product *= Noise.NextUniform();
+			}
+			return Count;
+		}
+
+		// Hoermann, "The transformed rejection method for generating Poisson random variables" (PTRS).
+		const double SqrtMean = FMath::Sqrt(Mean);
+		const double LogMean = Math::Log(Mean);
+		const double B = 0.931 + 2.53 * SqrtMean;
+		const double A = -0.059 + 0.02483 * B;
+		const double InvAlpha = 1.1239 + 1.1328 / (B - 3.4);
+		const double VR = 0.9277 - 3.6224 / (B - 2.0);
+
+		for (;;)
+		{
+			const double U = Noise.NextUniform() - 0.5;
+			const double V = Noise.NextUniform();
+			const double US = 0.5 - FMath::Abs(U);
+			const double K = Math::Floor((2.0 * A / US + B) * U + Mean + 0.43);
+
+			if (US >= 0.07 && V <= VR)
+			{
+				return static_cast<int32>(FMath::Min(K, static_cast<double>(MAX_int32)));
+			}
+
+			if (K < 0.0 || (US < 0.013 && V > US))
+			{
+				continue;
+			}
+
+			if (Math::Log(V * InvAlpha / (A / (US * US) + B)) <= -Mean + K * LogMean - Math::LogGamma(K + 1.0))
+			{
+				return static_cast<int32>(FMath::Min(K, static_cast<double>(MAX_int32)));
+			}
+		}
+	}
+
+	static int32 SampleBinomial(FSampleNoise& Noise, const int32 Trials, const double Probability)
+	{
+		if (Trials <= 0 || !(Probability > 0.0))
+		{
+			return 0;
+		}
+		if (Probability >= 1.0)
+		{
+			return Trials;
+		}
+
+		// Sample the rarer outcome, and flip the result back.
+		const bool bFlip = Probability > 0.5;
+		const double P = bFlip ? 1.0 - Probability : Probability;
+		const double Q = 1.0 - P;
+		const double N = Trials;
+
+		int32 Successes;
+
+		if (N * P < 10.0)
+		{
+			// Inversion, walking up the CDF from 0.
+			const double S = P / Q;
+			const double A = (N + 1.0) * S;
+			double R = Math::Exp(N * Math::Log(Q));
+			double U = Noise.NextUniform();
+
+			Successes = 0;
+			while (U > R && Successes < Trials)
+			{
+				U -= R;
+				++Successes;
+				R *= A / Successes - S;
+			}
+		}
+		else
+		{
+			// Hoermann, "The generation of binomial random variates" (BTRS).
+			const double SPQ = FMath::Sqrt(N * P * Q);
+			const double B = 1.15 + 2.53 * SPQ;
+			const double A = -0.0873 + 0.0248 * B + 0.01 * P;
+			const double C = N * P + 0.5;
+			const double VR = 0.92 - 4.2 / B;
+			const double Alpha = (2.83 + 5.1 / B) * SPQ;
+			const double LogPQ = Math::Log(P / Q);
+			const double M = Math::Floor((N + 1.0) * P);
+			const double H = Math::LogGamma(M + 1.0) + Math::LogGamma(N - M + 1.0);
+
+			for (;;)
+			{
+				const double U = Noise.NextUniform() - 0.5;
+				const double V = Noise.NextUniform();
+				const double US = 0.5 - FMath::Abs(U);
+				const double K = Math::Floor((2.0 * A / US + B) * U + C);
+
+				if (K < 0.0 || K > N)
+				{
+					continue;
+				}
+
+				if (US >= 0.07 && V <= VR)
+				{
+					Successes = static_cast<int32>(K);
+					break;
+				}
+
+				if (Math::Log(V * Alpha / (A / (US * US) + B)) <= H - Math::LogGamma(K + 1.0) - Math::LogGamma(N - K + 1.0) + (K - M) * LogPQ)
+				{
+					Successes = static_cast<int32>(K);
+					break;
+				}
+			}
+		}
+
+		return bFlip ? Trials - Successes : Successes;
+	}
+
+	static double SampleTriangular(FSampleNoise& Noise, const double Min, const double Mode, const double Max)
+	{
+		const double U = Noise.NextUniform();
+
+		if (!(Max > Min))
+		{
+			return Min;
+		}
+
+		const double Peak = FMath::Clamp(Mode, Min, Max);
+		const double Range = Max - Min;
+
+		if (U * Range < Peak - Min)
+		{
+			return Min + FMath::Sqrt(U * Range * (Peak - Min));
+		}
+		return Max - FMath::Sqrt((1.0 - U) * Range * (Max - Peak));
+	}
+
+	// Number of samples whose first noise values are generated together.
+	static constexpr int32 SampleChunkSize = 256;
+
+	template <typename T, typename SamplerType>
+	void FillSamples(FSquirrelState& State, const TArrayView<T> Out, SamplerType&& Sampler)
+	{
+		SQUIRREL_COUNT(DistributionSamples, Out.Num());
+
+		const uint32 Seed = GetGlobalSeed();
+		uint32 First[SampleChunkSize];
+
+		for (int32 Offset = 0; Offset < Out.Num(); Offset += SampleChunkSize)
+		{
+			const int32 Count = FMath::Min(SampleChunkSize, Out.Num() - Offset);
+			const int32 Start = State.Position;
+			Fill(State, MakeArrayView(First, Count));
+
+			T* Dest = Out.GetData() + Offset;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				FSampleNoise Noise(static_cast<int32>(static_cast<uint32>(Start) + static_cast<uint32>(i)), Seed, First[i]);
+				Dest[i] = Sampler(Noise);
+			}
+		}
+	}
+}
+
+namespace Squirrel
+{
+	double NextNormal(FSquirrelState& State, const double Mean, const double StdDev)
+	{
+		Distributions::FSampleNoise Noise(State);
+		return Mean + StdDev * Distributions::SampleNormal(Noise);
+	}
+
+	double NextExponential(FSquirrelState& State, const double Rate)
+	{
+		Distributions::FSampleNoise Noise(State);
+		return Distributions::SampleExponential(Noise) / Rate;
+	}
+
+	int32 NextPoisson(FSquirrelState& State, const double Mean)
+	{
+		Distributions::FSampleNoise Noise(State);
+		return Distributions::SamplePoisson(Noise, Mean);
+	}
+
+	int32 NextBinomial(FSquirrelState& State, const int32 Trials, const double Probability)
+	{
+		Distributions::FSampleNoise Noise(State);
+		return Distributions::SampleBinomial(Noise, Trials, Probability);
+	}
+
+	double NextTriangular(FSquirrelState& State, const double Min, const double Mode, const double Max)
+	{
+		Distributions::FSampleNoise Noise(State);
+		return Distributions::SampleTriangular(Noise, Min, Mode, Max);
+	}
+
+	void FillNormal(FSquirrelState& State, const TArrayView<double> Out, const double Mean, const double StdDev)
+	{
+		SQUIRREL_TRACE_BATCH(FillNormal, Out.Num());
+		Distributions::FillSamples(State, Out,
+			[Mean, StdDev](Distributions::FSampleNoise& Noise) { return Mean + StdDev * Distributions::SampleNormal(Noise); });
+	}
+
+	void FillExponential(FSquirrelState& State, const TArrayView<double> Out, const double Rate)
+	{
+		SQUIRREL_TRACE_BATCH(FillExponential, Out.Num());
+		Distributions::FillSamples(State, Out,
+			[Rate](Distributions::FSampleNoise& Noise) { return Distributions::SampleExponential(Noise) / Rate; });
+	}
+
+	void FillPoisson(FSquirrelState& State, const TArrayView<int32> Out, const double Mean)
+	{
+		SQUIRREL_TRACE_BATCH(FillPoisson, Out.Num());
+		Distributions::FillSamples(State, Out,
+			[Mean](Distributions::FSampleNoise& Noise) { return Distributions::SamplePoisson(Noise, Mean); });
+	}
+
+	void FillBinomial(FSquirrelState& State, const TArrayView<int32> Out, const int32 Trials, const double Probability)
+	{
+		SQUIRREL_TRACE_BATCH(FillBinomial, Out.Num());
+		Distributions::FillSamples(State, Out,
+			[Trials, Probability](Distributions::FSampleNoise& Noise) { return Distributions::SampleBinomial(Noise, Trials, Probability); });
+	}
+
+	void FillTriangular(FSquirrelState& State, const TArrayView<double> Out, const double Min, const double Mode, const double Max)
+	{
+		SQUIRREL_TRACE_BATCH(FillTriangular, Out.Num());
+		Distributions::FillSamples(State, Out,
+			[Min, Mode, Max](Distributions::FSampleNoise& Noise) { return Distributions::SampleTriangular(Noise, Min, Mode, Max); });
+	}
+}
\ No newline at end of file
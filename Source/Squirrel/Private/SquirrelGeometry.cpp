@@ -0,0 +1,322 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelGeometry.h"
+#include "Math/VectorRegister.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	Changing the number of positions used per element,
+ *	or the order they are consumed in, will change the
+ *	output of existing seeds.
+ */
+
+namespace Squirrel::Geometry
+{
+	// Number of elements generated per chunk of uniforms. Must be a multiple of 4 for the vectorized float paths.
+	static constexpr int32 ChunkElements = 64;
+
+	/*
+	 * Element builders for the double paths. Each takes exactly as many uniforms as its element consumes positions.
+	 */
+
+	static FVector MakeUnitVector(const double* U)
+	{
+		const double Z = 2.0 * U[0] - 1.0;
+		const double Phi = UE_DOUBLE_TWO_PI * U[1];
+		const double R = FMath::Sqrt(FMath::Max(0.0, 1.0 - Z * Z));
+		return FVector(R * FMath::Cos(Phi), R * FMath::Sin(Phi), Z);
+	}
+
+	static FVector MakePointInBox(const double* U, const FBox& Box)
+	{
+		return Box.Min + (Box.Max - Box.Min) * FVector(U[0], U[1], U[2]);
+	}
+
+	static FVector MakePointInSphere(const double* U, const double Radius)
+	{
+		return MakeUnitVector(U) * (Radius * FMath::Pow(U[2], 1.0 / 3.0));
+	}
+
+	static FVector2D MakePointInDisc(const double* U, const double Radius)
+	{
+		const double R = Radius * FMath::Sqrt(U[0]);
+		const double Theta = UE_DOUBLE_TWO_PI * U[1];
+		return FVector2D(R * FMath::Cos(Theta), R * FMath::Sin(Theta));
+	}
+
+	static FRotator MakeRotator(const double* U)
+	{
+		return FRotator(U[0] * 360.0, U[1] * 360.0, U[2] * 360.0);
+	}
+
+	// Shoemake's uniform random rotation.
+	static FQuat MakeQuat(const double* U)
+	{
+		const double A = FMath::Sqrt(1.0 - U[0]);
+		const double B = FMath::Sqrt(U[0]);
+		const double Theta1 = UE_DOUBLE_TWO_PI * U[1];
+		const double Theta2 = UE_DOUBLE_TWO_PI * U[2];
+		return FQuat(A * FMath::Sin(Theta1), A * FMath::Cos(Theta1), B * FMath::Sin(Theta2), B * FMath::Cos(Theta2));
+	}
+
+	template <int32 Positions, typename T, typename FBuilder>
+	static void FillDouble(FSquirrelState& State, const TArrayView<T> Out, FBuilder&& Build)
+	{
+		double Uniforms[ChunkElements * Positions];
+
+		for (int32 Offset = 0; Offset < Out.Num(); Offset += ChunkElements)
+		{
+			const int32 Count = FMath::Min(ChunkElements, Out.Num() - Offset);
+			Fill(State, MakeArrayView(Uniforms, Count * Positions));
+
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Out[Offset + i] = Build(Uniforms + i * Positions);
+			}
+		}
+	}
+
+	/*
+	 * The float paths generate uniforms for a chunk of elements, then transpose them so that each register holds the
+	 * same position of four consecutive elements. A kernel turns those into one register per output component, which
+	 * are then written back out into the element type.
+	 */
+	template <int32 Positions, int32 Components, typename T, typename FKernel, typename FStore>
+	static void FillFloat(FSquirrelState& State, const TArrayView<T> Out, FKernel&& Kernel, FStore&& Store)
+	{
+		static_assert(ChunkElements % 4 == 0);
+
+		float Uniforms[ChunkElements * Positions];
+
+		for (int32 Offset = 0; Offset < Out.Num(); Offset += ChunkElements)
+		{
+			const int32 Count = FMath::Min(ChunkElements, Out.Num() - Offset);
+			Fill(State, MakeArrayView(Uniforms, Count * Positions));
+
+			// Lanes past the end of the array are computed, but never stored, so pad them with valid input.
+			const int32 PaddedCount = Align(Count, 4);
+			for (int32 i = Count * Positions; i < PaddedCount * Positions; ++i)
+			{
+				Uniforms[i] = 0.f;
+			}
+
+			for (int32 Block = 0; Block < PaddedCount; Block += 4)
+			{
+				const float* U = Uniforms + Block * Positions;
+
+				VectorRegister4Float Lanes[Positions];
+				for (int32 p = 0; p < Positions; ++p)
+				{
+					Lanes[p] = MakeVectorRegisterFloat(U[p], U[Positions + p], U[Positions * 2 + p], U[Positions * 3 + p]);
+				}
+
+				VectorRegister4Float Results[Components];
+				Kernel(Lanes, Results);
+
+				alignas(16) float Stored[Components][4];
+				for (int32 c = 0; c < Components; ++c)
+				{
+					VectorStoreAligned(Results[c], Stored[c]);
+				}
+
+				const int32 BlockCount = FMath::Min(4, Count - Block);
+				for (int32 Lane = 0; Lane < BlockCount; ++Lane)
+				{
+					Store(Out[Offset + Block + Lane], Stored, Lane);
+				}
+			}
+		}
+	}
+
+	/*
+	 * Vectorized kernels for the float paths. These mirror the element builders above.
+	 */
+
+	static FORCEINLINE void UnitVectorKernel(const VectorRegister4Float* U, VectorRegister4Float (&Out)[3])
+	{
+		const VectorRegister4Float One = GlobalVectorConstants::FloatOne;
+		const VectorRegister4Float Z = VectorMultiplyAdd(U[0], VectorSetFloat1(2.f), VectorNegate(One));
+		const VectorRegister4Float Phi = VectorMultiply(U[1], VectorSetFloat1(UE_TWO_PI));
+		const VectorRegister4Float R = VectorSqrt(VectorMax(VectorZeroFloat(), VectorNegateMultiplyAdd(Z, Z, One)));
+
+		VectorRegister4Float Sin, Cos;
+		VectorSinCos(&Sin, &Cos, &Phi);
+
+		Out[0] = VectorMultiply(R, Cos);
+		Out[1] = VectorMultiply(R, Sin);
+		Out[2] = Z;
+	}
+
+	static FORCEINLINE void StoreVector3f(FVector3f& Dest, const float (&Stored)[3][4], const int32 Lane)
+	{
+		Dest = FVector3f(Stored[0][Lane], Stored[1][Lane], Stored[2][Lane]);
+	}
+}
+
+namespace Squirrel
+{
+	FVector NextUnitVector(FSquirrelState& State)
+	{
+		const double U[Geometry::PositionsPerUnitVector] = { NextReal(State), NextReal(State) };
+		return Geometry::MakeUnitVector(U);
+	}
+
+	FVector NextPointInBox(FSquirrelState& State, const FBox& Box)
+	{
+		const double U[Geometry::PositionsPerPointInBox] = { NextReal(State), NextReal(State), NextReal(State) };
+		return Geometry::MakePointInBox(U, Box);
+	}
+
+	FVector NextPointInSphere(FSquirrelState& State, const double Radius)
+	{
+		const double U[Geometry::PositionsPerPointInSphere] = { NextReal(State), NextReal(State), NextReal(State) };
+		return Geometry::MakePointInSphere(U, Radius);
+	}
+
+	FVector2D NextPointInDisc(FSquirrelState& State, const double Radius)
+	{
+		const double U[Geometry::PositionsPerPointInDisc] = { NextReal(State), NextReal(State) };
+		return Geometry::MakePointInDisc(U, Radius);
+	}
+
+	FRotator NextRotator(FSquirrelState& State)
+	{
+		const double U[Geometry::PositionsPerRotator] = { NextReal(State), NextReal(State), NextReal(State) };
+		return Geometry::MakeRotator(U);
+	}
+
+	FQuat NextQuat(FSquirrelState& State)
+	{
+		const double U[Geometry::PositionsPerQuat] = { NextReal(State), NextReal(State), NextReal(State) };
+		return Geometry::MakeQuat(U);
+	}
+
+	void FillUnitVectors(FSquirrelState& State, const TArrayView<FVector> Out)
+	{
+		Geometry::FillDouble<Geometry::PositionsPerUnitVector>(State, Out, &Geometry::MakeUnitVector);
+	}
+
+	void FillUnitVectors(FSquirrelState& State, const TArrayView<FVector3f> Out)
+	{
+		Geometry::FillFloat<Geometry::PositionsPerUnitVector, 3>(State, Out, &Geometry::UnitVectorKernel, &Geometry::StoreVector3f);
+	}
+
+	void FillPointsInBox(FSquirrelState& State, const FBox& Box, const TArrayView<FVector> Out)
+	{
+		Geometry::FillDouble<Geometry::PositionsPerPointInBox>(State, Out,
+			[&Box](const double* U) { return Geometry::MakePointInBox(U, Box); });
+	}
+
+	void FillPointsInBox(FSquirrelState& State, const FBox3f& Box, const TArrayView<FVector3f> Out)
+	{
+		const FVector3f Size = Box.Max - Box.Min;
+
+		Geometry::FillFloat<Geometry::PositionsPerPointInBox, 3>(State, Out,
+			[&Box, &Size](const VectorRegister4Float* U, VectorRegister4Float (&Result)[3])
+			{
+				Result[0] = VectorMultiplyAdd(U[0], VectorSetFloat1(Size.X), VectorSetFloat1(Box.Min.X));
+				Result[1] = VectorMultiplyAdd(U[1], VectorSetFloat1(Size.Y), VectorSetFloat1(Box.Min.Y));
+				Result[2] = VectorMultiplyAdd(U[2], VectorSetFloat1(Size.Z), VectorSetFloat1(Box.Min.Z));
+			},
+			&Geometry::StoreVector3f);
+	}
+
+	void FillPointsInSphere(FSquirrelState& State, const double Radius, const TArrayView<FVector> Out)
+	{
+		Geometry::FillDouble<Geometry::PositionsPerPointInSphere>(State, Out,
+			[Radius](const double* U) { return Geometry::MakePointInSphere(U, Radius); });
+	}
+
+	void FillPointsInSphere(FSquirrelState& State, const float Radius, const TArrayView<FVector3f> Out)
+	{
+		Geometry::FillFloat<Geometry::PositionsPerPointInSphere, 3>(State, Out,
+			[Radius](const VectorRegister4Float* U, VectorRegister4Float (&Result)[3])
+			{
+				Geometry::UnitVectorKernel(U, Result);
+
+				const VectorRegister4Float Scale = VectorMultiply(VectorPow(U[2], VectorSetFloat1(1.f / 3.f)), VectorSetFloat1(Radius));
+				Result[0] = VectorMultiply(Result[0], Scale);
+				Result[1] = VectorMultiply(Result[1], Scale);
+				Result[2] = VectorMultiply(Result[2], Scale);
+			},
+			&Geometry::StoreVector3f);
+	}
+
+	void FillPointsInDisc(FSquirrelState& State, const double Radius, const TArrayView<FVector2D> Out)
+	{
+		Geometry::FillDouble<Geometry::PositionsPerPointInDisc>(State, Out,
+			[Radius](const double* U) { return Geometry::MakePointInDisc(U, Radius); });
+	}
+
+	void FillPointsInDisc(FSquirrelState& State, const float Radius, const TArrayView<FVector2f> Out)
+	{
+		Geometry::FillFloat<Geometry::PositionsPerPointInDisc, 2>(State, Out,
+			[Radius](const VectorRegister4Float* U, VectorRegister4Float (&Result)[2])
+			{
+				const VectorRegister4Float R = VectorMultiply(VectorSqrt(U[0]), VectorSetFloat1(Radius));
+				const VectorRegister4Float Theta = VectorMultiply(U[1], VectorSetFloat1(UE_TWO_PI));
+
+				VectorRegister4Float Sin, Cos;
+				VectorSinCos(&Sin, &Cos, &Theta);
+
+				Result[0] = VectorMultiply(R, Cos);
+				Result[1] = VectorMultiply(R, Sin);
+			},
+			[](FVector2f& Dest, const float (&Stored)[2][4], const int32 Lane)
+			{
+				Dest = FVector2f(Stored[0][Lane], Stored[1][Lane]);
+			});
+	}
+
+	void FillRotators(FSquirrelState& State, const TArrayView<FRotator> Out)
+	{
+		Geometry::FillDouble<Geometry::PositionsPerRotator>(State, Out, &Geometry::MakeRotator);
+	}
+
+	void FillRotators(FSquirrelState& State, const TArrayView<FRotator3f> Out)
+	{
+		Geometry::FillFloat<Geometry::PositionsPerRotator, 3>(State, Out,
+			[](const VectorRegister4Float* U, VectorRegister4Float (&Result)[3])
+			{
+				const VectorRegister4Float Degrees = VectorSetFloat1(360.f);
+				Result[0] = VectorMultiply(U[0], Degrees);
+				Result[1] = VectorMultiply(U[1], Degrees);
+				Result[2] = VectorMultiply(U[2], Degrees);
+			},
+			[](FRotator3f& Dest, const float (&Stored)[3][4], const int32 Lane)
+			{
+				Dest = FRotator3f(Stored[0][Lane], Stored[1][Lane], Stored[2][Lane]);
+			});
+	}
+
+	void FillQuats(FSquirrelState& State, const TArrayView<FQuat> Out)
+	{
+		Geometry::FillDouble<Geometry::PositionsPerQuat>(State, Out, &Geometry::MakeQuat);
+	}
+
+	void FillQuats(FSquirrelState& State, const TArrayView<FQuat4f> Out)
+	{
+		Geometry::FillFloat<Geometry::PositionsPerQuat, 4>(State, Out,
+			[](const VectorRegister4Float* U, VectorRegister4Float (&Result)[4])
+			{
+				const VectorRegister4Float A = VectorSqrt(VectorSubtract(GlobalVectorConstants::FloatOne, U[0]));
+				const VectorRegister4Float B = VectorSqrt(U[0]);
+				const VectorRegister4Float Theta1 = VectorMultiply(U[1], VectorSetFloat1(UE_TWO_PI));
+				const VectorRegister4Float Theta2 = VectorMultiply(U[2], VectorSetFloat1(UE_TWO_PI));
+
+				VectorRegister4Float Sin1, Cos1, Sin2, Cos2;
+				VectorSinCos(&Sin1, &Cos1, &Theta1);
+				VectorSinCos(&Sin2, &Cos2, &Theta2);
+
+				Result[0] = VectorMultiply(A, Sin1);
+				Result[1] = VectorMultiply(A, Cos1);
+				Result[2] = VectorMultiply(B, Sin2);
+				Result[3] = VectorMultiply(B, Cos2);
+			},
+			[](FQuat4f& Dest, const float (&Stored)[4][4], const int32 Lane)
+			{
+				Dest = FQuat4f(Stored[0][Lane], Stored[1][Lane], Stored[2][Lane], Stored[3][Lane]);
+			});
+	}
+}
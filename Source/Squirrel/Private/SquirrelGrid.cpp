@@ -0,0 +1,194 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelGrid.h"
+#include "SquirrelNoise5.hpp"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+#if INTEL_ISPC
+#include "SquirrelGrid.ispc.generated.h"
+#endif
+
+#if !defined(SQUIRREL_GRID_ISPC_ENABLED_DEFAULT)
+#define SQUIRREL_GRID_ISPC_ENABLED_DEFAULT 1
+#endif
+
+#if !INTEL_ISPC || UE_BUILD_SHIPPING
+static constexpr bool bSquirrel_Grid_ISPC_Enabled = INTEL_ISPC && SQUIRREL_GRID_ISPC_ENABLED_DEFAULT;
+#else
+static bool bSquirrel_Grid_ISPC_Enabled = SQUIRREL_GRID_ISPC_ENABLED_DEFAULT;
+static FAutoConsoleVariableRef CVarSquirrelGridISPCEnabled(
+	TEXT("Squirrel.Grid.ISPC"),
+	bSquirrel_Grid_ISPC_Enabled,
+	TEXT("Whether to use ISPC optimizations when filling noise grids. Output is identical either way."));
+#endif
+
+namespace Squirrel::Grid
+{
+	// Number of cells in a tile. Sized so that a tile of doubles fits comfortably in L1.
+	static constexpr int32 TileCells = 2048;
+
+	// Upper bound on the number of rows a single tile may span, for grids with very short rows.
+	static constexpr int32 MaxRowsPerTile = 256;
+
+	enum class EMapping : uint8
+	{
+		Uint,
+		ZeroToOne,
+		NegOneToOne
+	};
+
+	// Scalar equivalent of the ISPC kernels in SquirrelGrid.ispc.
+	template <EMapping Mapping, typename T>
+	static void ScalarRows(T* Out, const int32 OutPitch, const int32* RowBases, const int32 NumRows, const int32 RowLength,
+		const int32 OriginX, const int32 StrideX, const uint32 Seed)
+	{
+		for (int32 Row = 0; Row < NumRows; ++Row)
+		{
+			const uint32 Base = static_cast<uint32>(RowBases[Row]) + static_cast<uint32>(OriginX);
+			T* RowOut = Out + Row * OutPitch;
+
+			for (int32 i = 0; i < RowLength; ++i)
+			{
+				const uint32 Noise = Raw::SquirrelNoise5(static_cast<int32>(Base + static_cast<uint32>(i) * static_cast<uint32>(StrideX)), Seed);
+
+				if constexpr (Mapping == EMapping::Uint)
+				{
+					RowOut[i] = Noise;
+				}
+				else if constexpr (Mapping == EMapping::ZeroToOne)
+				{
+					RowOut[i] = Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise);
+				}
+				else
+				{
+					RowOut[i] = Raw::ONE_OVER_MAX_INT * static_cast<double>(static_cast<int32>(Noise));
+				}
+			}
+		}
+	}
+
+	template <EMapping Mapping, typename T>
+	static void EvaluateRows(T* Out, const int32 OutPitch, const int32* RowBases, const int32 NumRows, const int32 RowLength,
+		const int32 OriginX, const int32 StrideX, const uint32 Seed)
+	{
+#if INTEL_ISPC
+		if (bSquirrel_Grid_ISPC_Enabled)
+		{
+			if constexpr (Mapping == EMapping::Uint)
+			{
+				ispc::SquirrelNoiseRowsUint(Out, OutPitch, RowBases, NumRows, RowLength, OriginX, StrideX, Seed);
+			}
+			else if constexpr (Mapping == EMapping::ZeroToOne)
+			{
+				ispc::SquirrelNoiseRowsZeroToOne(Out, OutPitch, RowBases, NumRows, RowLength, OriginX, StrideX, Seed);
+			}
+			else
+			{
+				ispc::SquirrelNoiseRowsNegOneToOne(Out, OutPitch, RowBases, NumRows, RowLength, OriginX, StrideX, Seed);
+			}
+			return;
+		}
+#endif
+
+		ScalarRows<Mapping>(Out, OutPitch, RowBases, NumRows, RowLength, OriginX, StrideX, Seed);
+	}
+
+	/**
+	 * Splits a grid into tiles of whole rows (or segments of a row, for very long rows) and evaluates them in parallel.
+	 * GetRowBase returns the folded Y/Z contribution to a row's noise index.
+	 */
+	template <EMapping Mapping, typename T, typename FGetRowBase>
+	static void FillRows(const int32 NumRows, const int32 RowLength, const int32 OriginX, const int32 StrideX, const uint32 Seed,
+		FGetRowBase&& GetRowBase, const TArrayView<T> Out)
+	{
+		check(Out.Num() == NumRows * RowLength);
+		SQUIRREL_TRACE_BATCH(FillNoiseGrid, Out.Num());
+		SQUIRREL_COUNT(GridCells, Out.Num());
+
+		if (NumRows <= 0 || RowLength <= 0)
+		{
+			return;
+		}
+
+		const int32 SegmentLength = FMath::Min(RowLength, TileCells);
+		const int32 SegmentsPerRow = FMath::DivideAndRoundUp(RowLength, SegmentLength);
+		const int32 RowsPerTile = FMath::Clamp(TileCells / SegmentLength, 1, MaxRowsPerTile);
+		const int32 RowTiles = FMath::DivideAndRoundUp(NumRows, RowsPerTile);
+
+		ParallelFor(RowTiles * SegmentsPerRow,
+			[&](const int32 TileIndex)
+			{
+				const int32 FirstRow = (TileIndex / SegmentsPerRow) * RowsPerTile;
+				const int32 TileRows = FMath::Min(RowsPerTile, NumRows - FirstRow);
+				const int32 SegmentStart = (TileIndex % SegmentsPerRow) * SegmentLength;
+				const int32 TileLength = FMath::Min(SegmentLength, RowLength - SegmentStart);
+
+				int32 RowBases[MaxRowsPerTile];
+				for (int32 Row = 0; Row < TileRows; ++Row)
+				{
+					RowBases[Row] = GetRowBase(FirstRow + Row);
+				}
+
+				const int32 TileOriginX = static_cast<int32>(static_cast<uint32>(OriginX) + static_cast<uint32>(SegmentStart) * static_cast<uint32>(StrideX));
+				T* TileOut = Out.GetData() + FirstRow * RowLength + SegmentStart;
+
+				EvaluateRows<Mapping>(TileOut, RowLength, RowBases, TileRows, TileLength, TileOriginX, StrideX, Seed);
+			});
+	}
+
+	template <EMapping Mapping, typename T>
+	static void Fill2d(const FSquirrelGrid2D& Grid, const TArrayView<T> Out)
+	{
+		FillRows<Mapping>(Grid.Size.Y, Grid.Size.X, Grid.Origin.X, Grid.Stride.X, Grid.Seed,
+			[&Grid](const int32 Row)
+			{
+				const uint32 Y = static_cast<uint32>(Grid.Origin.Y) + static_cast<uint32>(Row) * static_cast<uint32>(Grid.Stride.Y);
+				return static_cast<int32>(Raw::PRIME1 * Y);
+			},
+			Out);
+	}
+
+	template <EMapping Mapping, typename T>
+	static void Fill3d(const FSquirrelGrid3D& Grid, const TArrayView<T> Out)
+	{
+		FillRows<Mapping>(Grid.Size.Y * Grid.Size.Z, Grid.Size.X, Grid.Origin.X, Grid.Stride.X, Grid.Seed,
+			[&Grid](const int32 Row)
+			{
+				const uint32 Y = static_cast<uint32>(Grid.Origin.Y) + static_cast<uint32>(Row % Grid.Size.Y) * static_cast<uint32>(Grid.Stride.Y);
+				const uint32 Z = static_cast<uint32>(Grid.Origin.Z) + static_cast<uint32>(Row / Grid.Size.Y) * static_cast<uint32>(Grid.Stride.Z);
+				return static_cast<int32>(Raw::PRIME1 * Y + Raw::PRIME2 * Z);
+			},
+			Out);
+	}
+
+	void Fill2dNoiseUint(const FSquirrelGrid2D& Grid, const TArrayView<uint32> Out)
+	{
+		Fill2d<EMapping::Uint>(Grid, Out);
+	}
+
+	void Fill2dNoiseZeroToOne(const FSquirrelGrid2D& Grid, const TArrayView<double> Out)
+	{
+		Fill2d<EMapping::ZeroToOne>(Grid, Out);
+	}
+
+	void Fill2dNoiseNegOneToOne(const FSquirrelGrid2D& Grid, const TArrayView<double> Out)
+	{
+		Fill2d<EMapping::NegOneToOne>(Grid, Out);
+	}
+
+	void Fill3dNoiseUint(const FSquirrelGrid3D& Grid, const TArrayView<uint32> Out)
+	{
+		Fill3d<EMapping::Uint>(Grid, Out);
+	}
+
+	void Fill3dNoiseZeroToOne(const FSquirrelGrid3D& Grid, const TArrayView<double> Out)
+	{
+		Fill3d<EMapping::ZeroToOne>(Grid, Out);
+	}
+
+	void Fill3dNoiseNegOneToOne(const FSquirrelGrid3D& Grid, const TArrayView<double> Out)
+	{
+		Fill3d<EMapping::NegOneToOne>(Grid, Out);
+	}
+}
@@ -0,0 +1,304 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelLowDiscrepancy.h"
+#include "SquirrelNoise5.hpp"
+#include "Async/ParallelFor.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The recurrence constants, direction numbers, and
+ *	scrambling here determine the output of existing seeds.
+ */
+
+namespace Squirrel::LowDiscrepancy
+{
+	// Number of points handed to each worker by the Fill functions.
+	static constexpr int32 BatchSize = 1024;
+
+	// Salted, so that the scrambles don't coincide with the child seeds of SplitSeed, which are Get1dNoiseUint(N, ...).
+	static constexpr int32 ScrambleSalt = 0x10D15C;
+
+	// 2^64 / Phi_D^(i + 1), for axis i of the D-dimensional R-sequence, where Phi_D is the positive root of x^(D+1) = x + 1.
+	// Computed in 64-bit fixed point, so that points are exact and don't drift at high indices.
+	static constexpr uint64 RdAlphas[4][4] = {
+		{ 0x9E3779B97F4A7C16, 0, 0, 0 },
+		{ 0xC13FA9A902A6328F, 0x91E10DA5C79E7B1D, 0, 0 },
+		{ 0xD1B54A32D192ED04, 0xABC98388FB8FAC03, 0x8CB92BA72F3D8DD7, 0 },
+		{ 0xDB4F0B9175AE2165, 0xBBE0563303A4615F, 0xA0F2EC75A1FE1576, 0x89E182857D9ED689 }
+	};
+
+	// The bases of the Halton axes, and the number of digits that cover every uint32 index, with a resolution of ~2^-32.
+	static constexpr uint32 HaltonBases[4] = { 2, 3, 5, 7 };
+	static constexpr int32 HaltonDigits[4] = { 32, 21, 14, 12 };
+
+	// Sobol direction numbers, V[Axis][Bit]. Axis 0 is the van der Corput sequence, and the others use the primitive
+	// polynomials and initial values of Joe and Kuo (new-joe-kuo-6.21201).
+	struct FSobolDirections
+	{
+		uint32 V[4][32];
+
+		constexpr FSobolDirections()
+		  : V()
+		{
+			constexpr int32 Degrees[4] = { 0, 1, 2, 3 };
+			constexpr uint32 Coefficients[4] = { 0, 0, 1, 1 };
+			constexpr uint32 InitialValues[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 3, 0 }, { 1, 3, 1 } };
+
+			for (int32 Bit = 0; Bit < 32; ++Bit)
+			{
+				V[0][Bit] = 1u << (31 - Bit);
+			}
+
+			for (int32 Axis = 1; Axis < 4; ++Axis)
+			{
+				const int32 Degree = Degrees[Axis];
+				for (int32 Bit = 0; Bit < 32; ++Bit)
+				{
+					if (Bit < Degree)
+					{
+						V[Axis][Bit] = InitialValues[Axis][Bit] << (31 - Bit);
+						continue;
+					}
+
+					uint32 Value = V[Axis][Bit - Degree] ^ (V[Axis][Bit - Degree] >> Degree);
+					for (int32 i = 1; i < Degree; ++i)
+					{
+						if ((Coefficients[Axis] >> (Degree - 1 - i)) & 1)
+						{
+							Value ^= V[Axis][Bit - i];
+						}
+					}
+					V[Axis][Bit] = Value;
+				}
+			}
+		}
+	};
+
+	static constexpr FSobolDirections SobolDirections;
+
+	static_assert(SobolDirections.V[1][1] == 0xC0000000 && SobolDirections.V[2][1] == 0xC0000000 && SobolDirections.V[3][2] == 0x20000000);
+
+	static constexpr double OneOver2Pow32 = 1.0 / 4294967296.0;
+
+	// Laine-Karras permutation with the constants of Burley. Each output bit only depends on the same and lower input bits.
+	static uint32 LaineKarrasPermutation(uint32 X, const uint32 Seed)
+	{
+		X += Seed;
+		X ^= X * 0x6C50B47C;
+		X ^= X * 0xB82F1E52;
+		X ^= X * 0xC7AFE638;
+		X ^= X * 0x8D22F6E6;
+		return X;
+	}
+
+	// Owen scrambling: each bit is flipped depending on the bits above it, so every aligned block of 2^k values is mapped
+	// onto another, and the stratification of the sequence is kept.
+	static uint32 NestedUniformScramble(const uint32 X, const uint32 Seed)
+	{
+		return ReverseBits(LaineKarrasPermutation(ReverseBits(X), Seed));
+	}
+
+	static uint32 Sobol(uint32 Index, const int32 Axis)
+	{
+		uint32 X = 0;
+		for (int32 Bit = 0; Index; Index >>= 1, ++Bit)
+		{
+			if (Index & 1)
+			{
+				X ^= SobolDirections.V[Axis][Bit];
+			}
+		}
+		return X;
+	}
+
+	// Radical inverse of Index in the base of Axis, with each digit shifted by an amount that depends on the digits below
+	// it, so that every node of the digit tree is permuted independently.
+	static double ScrambledRadicalInverse(uint32 Index, const int32 Axis, const uint32 Seed)
+	{
+		const uint32 Base = HaltonBases[Axis];
+		const double InvBase = 1.0 / Base;
+
+		double Result = 0.0;
+		double Factor = InvBase;
+		uint32 Prefix = 0;
+		uint64 Power = 1;
+
+		for (int32 Digit = 0; Digit < HaltonDigits[Axis]; ++Digit)
+		{
+			const uint32 Value = Index % Base;
+			Index /= Base;
+
+			const uint32 Shift = Raw::Get2dNoiseUint(Digit, static_cast<int32>(Prefix), Seed) % Base;
+			Result += ((Value + Shift) % Base) * Factor;
+
+			Prefix += static_cast<uint32>(Value * Power);
+			Power *= Base;
+			Factor *= InvBase;
+		}
+
+		return Result;
+	}
+
+	// Everything a seed determines, derived once per call or per batch.
+	template <int32 D>
+	struct TScramble
+	{
+		uint64 Offsets[D];
+		uint32 AxisSeeds[D];
+		uint32 IndexSeed;
+
+		TScramble(const ESequence Sequence, const uint32 Seed)
+		{
+			const uint32 SequenceSeed = HashCombine(ScrambleSalt + static_cast<int32>(Sequence), Seed);
+
+			for (int32 Axis = 0; Axis < D; ++Axis)
+			{
+				Offsets[Axis] = Raw::Get1dNoiseUint64(Axis, SequenceSeed);
+				AxisSeeds[Axis] = Raw::Get1dNoiseUint(Axis, SequenceSeed);
+			}
+			IndexSeed = Raw::Get1dNoiseUint(D, SequenceSeed);
+		}
+	};
+
+	template <int32 D>
+	static void Evaluate(const ESequence Sequence, const uint32 Index, const TScramble<D>& Scramble, double (&Out)[D])
+	{
+		switch (Sequence)
+		{
+		case ESequence::Rd:
+			for (int32 Axis = 0; Axis < D; ++Axis)
+			{
+				Out[Axis] = Raw::Noise64ToZeroToOne(Scramble.Offsets[Axis] + Index * RdAlphas[D - 1][Axis]);
+			}
+			break;
+
+		case ESequence::Halton:
+			for (int32 Axis = 0; Axis < D; ++Axis)
+			{
+				Out[Axis] = ScrambledRadicalInverse(Index, Axis, Scramble.AxisSeeds[Axis]);
+			}
+			break;
+
+		default:
+		{
+			const uint32 Shuffled = NestedUniformScramble(Index, Scramble.IndexSeed);
+			for (int32 Axis = 0; Axis < D; ++Axis)
+			{
+				Out[Axis] = NestedUniformScramble(Sobol(Shuffled, Axis), Scramble.AxisSeeds[Axis]) * OneOver2Pow32;
+			}
+			break;
+		}
+		}
+	}
+
+	static void ToPoint(const double (&P)[1], double& Out) { Out = P[0]; }
+	static void ToPoint(const double (&P)[2], FVector2D& Out) { Out = FVector2D(P[0], P[1]); }
+	static void ToPoint(const double (&P)[3], FVector& Out) { Out = FVector(P[0], P[1], P[2]); }
+	static void ToPoint(const double (&P)[4], FVector4& Out) { Out = FVector4(P[0], P[1], P[2], P[3]); }
+
+	template <int32 D, typename T>
+	static T Sample(const ESequence Sequence, const uint32 Index, const uint32 Seed)
+	{
+		SQUIRREL_COUNT(LowDiscrepancyPoints, 1);
+
+		double P[D];
+		Evaluate<D>(Sequence, Index, TScramble<D>(Sequence, Seed), P);
+
+		T Point;
+		ToPoint(P, Point);
+		return Point;
+	}
+
+	template <int32 D, typename T>
+	static void FillPoints(FSquirrelState& State, const ESequence Sequence, const TArrayView<T> Out)
+	{
+		SQUIRREL_TRACE_BATCH(FillLowDiscrepancy, Out.Num());
+		SQUIRREL_COUNT(LowDiscrepancyPoints, Out.Num());
+
+		const TScramble<D> Scramble(Sequence, GetGlobalSeed());
+		const uint32 Start = static_cast<uint32>(State.Position);
+
+		ParallelFor(FMath::DivideAndRoundUp(Out.Num(), BatchSize),
+			[&](const int32 BatchIndex)
+			{
+				const int32 End = FMath::Min((BatchIndex + 1) * BatchSize, Out.Num());
+				for (int32 i = BatchIndex * BatchSize; i < End; ++i)
+				{
+					double P[D];
+					Evaluate<D>(Sequence, Start + static_cast<uint32>(i), Scramble, P);
+					ToPoint(P, Out[i]);
+				}
+			});
+
+		State.Position = static_cast<int32>(Start + static_cast<uint32>(Out.Num()));
+	}
+
+	// The index of the next point of a stream, advancing it with the same wrap-around as the other streams.
+	static uint32 NextIndex(FSquirrelState& State)
+	{
+		const uint32 Index = static_cast<uint32>(State.Position);
+		State.Position = static_cast<int32>(Index + 1);
+		return Index;
+	}
+
+	double Sample1D(const ESequence Sequence, const uint32 Index, const uint32 Seed)
+	{
+		return Sample<1, double>(Sequence, Index, Seed);
+	}
+
+	FVector2D Sample2D(const ESequence Sequence, const uint32 Index, const uint32 Seed)
+	{
+		return Sample<2, FVector2D>(Sequence, Index, Seed);
+	}
+
+	FVector Sample3D(const ESequence Sequence, const uint32 Index, const uint32 Seed)
+	{
+		return Sample<3, FVector>(Sequence, Index, Seed);
+	}
+
+	FVector4 Sample4D(const ESequence Sequence, const uint32 Index, const uint32 Seed)
+	{
+		return Sample<4, FVector4>(Sequence, Index, Seed);
+	}
+
+	double Next1D(FSquirrelState& State, const ESequence Sequence)
+	{
+		return Sample1D(Sequence, NextIndex(State), GetGlobalSeed());
+	}
+
+	FVector2D Next2D(FSquirrelState& State, const ESequence Sequence)
+	{
+		return Sample2D(Sequence, NextIndex(State), GetGlobalSeed());
+	}
+
+	FVector Next3D(FSquirrelState& State, const ESequence Sequence)
+	{
+		return Sample3D(Sequence, NextIndex(State), GetGlobalSeed());
+	}
+
+	FVector4 Next4D(FSquirrelState& State, const ESequence Sequence)
+	{
+		return Sample4D(Sequence, NextIndex(State), GetGlobalSeed());
+	}
+
+	void Fill(FSquirrelState& State, const ESequence Sequence, const TArrayView<double> Out)
+	{
+		FillPoints<1>(State, Sequence, Out);
+	}
+
+	void Fill(FSquirrelState& State, const ESequence Sequence, const TArrayView<FVector2D> Out)
+	{
+		FillPoints<2>(State, Sequence, Out);
+	}
+
+	void Fill(FSquirrelState& State, const ESequence Sequence, const TArrayView<FVector> Out)
+	{
+		FillPoints<3>(State, Sequence, Out);
+	}
+
+	void Fill(FSquirrelState& State, const ESequence Sequence, const TArrayView<FVector4> Out)
+	{
+		FillPoints<4>(State, Sequence, Out);
+	}
+}
\ No newline at end of file
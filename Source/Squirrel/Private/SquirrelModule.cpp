@@ -1,6 +1,8 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Modules/ModuleManager.h"
+#include "Containers/Ticker.h"
+#include "SquirrelStats.h"
 
 #define LOCTEXT_NAMESPACE "SquirrelModule"
 
@@ -9,14 +11,30 @@ class FSquirrelModule final : public IModuleInterface
 public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+#if SQUIRREL_INSTRUMENTATION
+	FTSTicker::FDelegateHandle StatsTickerHandle;
+#endif
 };
 
 void FSquirrelModule::StartupModule()
 {
+#if SQUIRREL_INSTRUMENTATION
+	StatsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(TEXT("SquirrelStats"), 0.0f,
+		[](float)
+		{
+			Squirrel::Stats::Publish();
+			return true;
+		});
+#endif
 }
 
 void FSquirrelModule::ShutdownModule()
 {
+#if SQUIRREL_INSTRUMENTATION
+	FTSTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+#endif
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,351 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelNoise5Simd.h"
+#include "SquirrelNoise5.hpp"
+#include "HAL/IConsoleManager.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif PLATFORM_CPU_ARM_FAMILY
+#include <arm_neon.h>
+#endif
+
+// MSVC exposes every intrinsic regardless of the compiler's target, clang and gcc must be told per-function.
+#if PLATFORM_CPU_X86_FAMILY && (defined(__clang__) || defined(__GNUC__))
+#define SQUIRREL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SQUIRREL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SQUIRREL_TARGET_SSE41
+#define SQUIRREL_TARGET_AVX2
+#endif
+
+static bool GSquirrelSimdEnabled = true;
+static FAutoConsoleVariableRef CVarSquirrelSimdEnabled(
+	TEXT("Squirrel.SimdEnabled"),
+	GSquirrelSimdEnabled,
+	TEXT("When disabled, batched SquirrelNoise5 generation falls back to the scalar implementation. Output is identical either way."));
+
+namespace Squirrel::Simd
+{
+	namespace Scalar
+	{
+		static void NoiseSequence(uint32* Out, const int32 Num, const int32 Start, const uint32 Seed)
+		{
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Out[i] = Raw::SquirrelNoise5(static_cast<int32>(static_cast<uint32>(Start) + static_cast<uint32>(i)), Seed);
+			}
+		}
+
+		static void NoiseGather(uint32* Out, const int32* Indices, const int32 Num, const uint32 Seed)
+		{
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Out[i] = Raw::SquirrelNoise5(Indices[i], Seed);
+			}
+		}
+
+		static void NoiseGather(uint32* Out, const int32* Indices, const uint32* Seeds, const int32 Num)
+		{
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Out[i] = Raw::SquirrelNoise5(Indices[i], Seeds[i]);
+			}
+		}
+	}
+
+#if PLATFORM_CPU_X86_FAMILY
+	namespace SSE41
+	{
+		SQUIRREL_TARGET_SSE41 static FORCEINLINE __m128i Mangle(__m128i Bits, const __m128i Seed)
+		{
+			Bits = _mm_mullo_epi32(Bits, _mm_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE1)));
+			Bits = _mm_add_epi32(Bits, Seed);
+			Bits = _mm_xor_si128(Bits, _mm_srli_epi32(Bits, 9));
+			Bits = _mm_add_epi32(Bits, _mm_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE2)));
+			Bits = _mm_xor_si128(Bits, _mm_srli_epi32(Bits, 11));
+			Bits = _mm_mullo_epi32(Bits, _mm_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE3)));
+			Bits = _mm_xor_si128(Bits, _mm_srli_epi32(Bits, 13));
+			Bits = _mm_add_epi32(Bits, _mm_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE4)));
+			Bits = _mm_xor_si128(Bits, _mm_srli_epi32(Bits, 15));
+			Bits = _mm_mullo_epi32(Bits, _mm_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE5)));
+			Bits = _mm_xor_si128(Bits, _mm_srli_epi32(Bits, 17));
+			return Bits;
+		}
+
+		SQUIRREL_TARGET_SSE41 static void NoiseSequence(uint32* Out, const int32 Num, const int32 Start, const uint32 Seed)
+		{
+			const __m128i SeedV = _mm_set1_epi32(static_cast<int32>(Seed));
+			const __m128i Step = _mm_set1_epi32(4);
+			__m128i Positions = _mm_add_epi32(_mm_set1_epi32(Start), _mm_setr_epi32(0, 1, 2, 3));
+
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), Mangle(Positions, SeedV));
+				Positions = _mm_add_epi32(Positions, Step);
+			}
+
+			Scalar::NoiseSequence(Out + i, Num - i, static_cast<int32>(static_cast<uint32>(Start) + static_cast<uint32>(i)), Seed);
+		}
+
+		SQUIRREL_TARGET_SSE41 static void NoiseGather(uint32* Out, const int32* Indices, const int32 Num, const uint32 Seed)
+		{
+			const __m128i SeedV = _mm_set1_epi32(static_cast<int32>(Seed));
+
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				const __m128i Positions = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Indices + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), Mangle(Positions, SeedV));
+			}
+
+			Scalar::NoiseGather(Out + i, Indices + i, Num - i, Seed);
+		}
+
+		SQUIRREL_TARGET_SSE41 static void NoiseGather(uint32* Out, const int32* Indices, const uint32* Seeds, const int32 Num)
+		{
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				const __m128i Positions = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Indices + i));
+				const __m128i SeedV = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Seeds + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), Mangle(Positions, SeedV));
+			}
+
+			Scalar::NoiseGather(Out + i, Indices + i, Seeds + i, Num - i);
+		}
+	}
+
+	namespace AVX2
+	{
+		SQUIRREL_TARGET_AVX2 static FORCEINLINE __m256i Mangle(__m256i Bits, const __m256i Seed)
+		{
+			Bits = _mm256_mullo_epi32(Bits, _mm256_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE1)));
+			Bits = _mm256_add_epi32(Bits, Seed);
+			Bits = _mm256_xor_si256(Bits, _mm256_srli_epi32(Bits, 9));
+			Bits = _mm256_add_epi32(Bits, _mm256_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE2)));
+			Bits = _mm256_xor_si256(Bits, _mm256_srli_epi32(Bits, 11));
+			Bits = _mm256_mullo_epi32(Bits, _mm256_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE3)));
+			Bits = _mm256_xor_si256(Bits, _mm256_srli_epi32(Bits, 13));
+			Bits = _mm256_add_epi32(Bits, _mm256_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE4)));
+			Bits = _mm256_xor_si256(Bits, _mm256_srli_epi32(Bits, 15));
+			Bits = _mm256_mullo_epi32(Bits, _mm256_set1_epi32(static_cast<int32>(Raw::SQ5_BIT_NOISE5)));
+			Bits = _mm256_xor_si256(Bits, _mm256_srli_epi32(Bits, 17));
+			return Bits;
+		}
+
+		SQUIRREL_TARGET_AVX2 static void NoiseSequence(uint32* Out, const int32 Num, const int32 Start, const uint32 Seed)
+		{
+			const __m256i SeedV = _mm256_set1_epi32(static_cast<int32>(Seed));
+			const __m256i Step = _mm256_set1_epi32(8);
+			__m256i Positions = _mm256_add_epi32(_mm256_set1_epi32(Start), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+			int32 i = 0;
+			for (; i + 8 <= Num; i += 8)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), Mangle(Positions, SeedV));
+				Positions = _mm256_add_epi32(Positions, Step);
+			}
+
+			Scalar::NoiseSequence(Out + i, Num - i, static_cast<int32>(static_cast<uint32>(Start) + static_cast<uint32>(i)), Seed);
+		}
+
+		SQUIRREL_TARGET_AVX2 static void NoiseGather(uint32* Out, const int32* Indices, const int32 Num, const uint32 Seed)
+		{
+			const __m256i SeedV = _mm256_set1_epi32(static_cast<int32>(Seed));
+
+			int32 i = 0;
+			for (; i + 8 <= Num; i += 8)
+			{
+				const __m256i Positions = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Indices + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), Mangle(Positions, SeedV));
+			}
+
+			Scalar::NoiseGather(Out + i, Indices + i, Num - i, Seed);
+		}
+
+		SQUIRREL_TARGET_AVX2 static void NoiseGather(uint32* Out, const int32* Indices, const uint32* Seeds, const int32 Num)
+		{
+			int32 i = 0;
+			for (; i + 8 <= Num; i += 8)
+			{
+				const __m256i Positions = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Indices + i));
+				const __m256i SeedV = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Seeds + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), Mangle(Positions, SeedV));
+			}
+
+			Scalar::NoiseGather(Out + i, Indices + i, Seeds + i, Num - i);
+		}
+	}
+#endif
+
+#if PLATFORM_CPU_ARM_FAMILY
+	namespace NEON
+	{
+		static FORCEINLINE uint32x4_t Mangle(uint32x4_t Bits, const uint32x4_t Seed)
+		{
+			Bits = vmulq_u32(Bits, vdupq_n_u32(Raw::SQ5_BIT_NOISE1));
+			Bits = vaddq_u32(Bits, Seed);
+			Bits = veorq_u32(Bits, vshrq_n_u32(Bits, 9));
+			Bits = vaddq_u32(Bits, vdupq_n_u32(Raw::SQ5_BIT_NOISE2));
+			Bits = veorq_u32(Bits, vshrq_n_u32(Bits, 11));
+			Bits = vmulq_u32(Bits, vdupq_n_u32(Raw::SQ5_BIT_NOISE3));
+			Bits = veorq_u32(Bits, vshrq_n_u32(Bits, 13));
+			Bits = vaddq_u32(Bits, vdupq_n_u32(Raw::SQ5_BIT_NOISE4));
+			Bits = veorq_u32(Bits, vshrq_n_u32(Bits, 15));
+			Bits = vmulq_u32(Bits, vdupq_n_u32(Raw::SQ5_BIT_NOISE5));
+			Bits = veorq_u32(Bits, vshrq_n_u32(Bits, 17));
+			return Bits;
+		}
+
+		static void NoiseSequence(uint32* Out, const int32 Num, const int32 Start, const uint32 Seed)
+		{
+			static constexpr uint32 Lanes[4] = { 0, 1, 2, 3 };
+			const uint32x4_t SeedV = vdupq_n_u32(Seed);
+			const uint32x4_t Step = vdupq_n_u32(4);
+			uint32x4_t Positions = vaddq_u32(vdupq_n_u32(static_cast<uint32>(Start)), vld1q_u32(Lanes));
+
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				vst1q_u32(Out + i, Mangle(Positions, SeedV));
+				Positions = vaddq_u32(Positions, Step);
+			}
+
+			Scalar::NoiseSequence(Out + i, Num - i, static_cast<int32>(static_cast<uint32>(Start) + static_cast<uint32>(i)), Seed);
+		}
+
+		static void NoiseGather(uint32* Out, const int32* Indices, const int32 Num, const uint32 Seed)
+		{
+			const uint32x4_t SeedV = vdupq_n_u32(Seed);
+
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				const uint32x4_t Positions = vld1q_u32(reinterpret_cast<const uint32*>(Indices + i));
+				vst1q_u32(Out + i, Mangle(Positions, SeedV));
+			}
+
+			Scalar::NoiseGather(Out + i, Indices + i, Num - i, Seed);
+		}
+
+		static void NoiseGather(uint32* Out, const int32* Indices, const uint32* Seeds, const int32 Num)
+		{
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				const uint32x4_t Positions = vld1q_u32(reinterpret_cast<const uint32*>(Indices + i));
+				vst1q_u32(Out + i, Mangle(Positions, vld1q_u32(Seeds + i)));
+			}
+
+			Scalar::NoiseGather(Out + i, Indices + i, Seeds + i, Num - i);
+		}
+	}
+#endif
+
+	static EInstructionSet DetectInstructionSet()
+	{
+#if PLATFORM_CPU_X86_FAMILY
+#if defined(_MSC_VER) && !defined(__clang__)
+		int32 Info[4];
+		__cpuid(Info, 0);
+		const int32 MaxLeaf = Info[0];
+
+		__cpuid(Info, 1);
+		const bool bHasSSE41 = (Info[2] & (1 << 19)) != 0;
+		const bool bHasOSXSave = (Info[2] & (1 << 27)) != 0;
+
+		bool bHasAVX2 = false;
+		if (MaxLeaf >= 7 && bHasOSXSave && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			__cpuidex(Info, 7, 0);
+			bHasAVX2 = (Info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		const bool bHasSSE41 = __builtin_cpu_supports("sse4.1");
+		const bool bHasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+		if (bHasAVX2)
+		{
+			return EInstructionSet::AVX2;
+		}
+		if (bHasSSE41)
+		{
+			return EInstructionSet::SSE41;
+		}
+		return EInstructionSet::Scalar;
+#elif PLATFORM_CPU_ARM_FAMILY
+		return EInstructionSet::NEON;
+#else
+		return EInstructionSet::Scalar;
+#endif
+	}
+
+	EInstructionSet GetInstructionSet()
+	{
+		static const EInstructionSet Detected = DetectInstructionSet();
+		return GSquirrelSimdEnabled ? Detected : EInstructionSet::Scalar;
+	}
+
+	void NoiseSequence(uint32* Out, const int32 Num, const int32 Start, const uint32 Seed)
+	{
+		switch (GetInstructionSet())
+		{
+#if PLATFORM_CPU_X86_FAMILY
+		case EInstructionSet::AVX2:
+			return AVX2::NoiseSequence(Out, Num, Start, Seed);
+		case EInstructionSet::SSE41:
+			return SSE41::NoiseSequence(Out, Num, Start, Seed);
+#elif PLATFORM_CPU_ARM_FAMILY
+		case EInstructionSet::NEON:
+			return NEON::NoiseSequence(Out, Num, Start, Seed);
+#endif
+		default:
+			return Scalar::NoiseSequence(Out, Num, Start, Seed);
+		}
+	}
+
+	void NoiseGather(uint32* Out, const int32* Indices, const int32 Num, const uint32 Seed)
+	{
+		switch (GetInstructionSet())
+		{
+#if PLATFORM_CPU_X86_FAMILY
+		case EInstructionSet::AVX2:
+			return AVX2::NoiseGather(Out, Indices, Num, Seed);
+		case EInstructionSet::SSE41:
+			return SSE41::NoiseGather(Out, Indices, Num, Seed);
+#elif PLATFORM_CPU_ARM_FAMILY
+		case EInstructionSet::NEON:
+			return NEON::NoiseGather(Out, Indices, Num, Seed);
+#endif
+		default:
+			return Scalar::NoiseGather(Out, Indices, Num, Seed);
+		}
+	}
+
+	void NoiseGather(uint32* Out, const int32* Indices, const uint32* Seeds, const int32 Num)
+	{
+		switch (GetInstructionSet())
+		{
+#if PLATFORM_CPU_X86_FAMILY
+		case EInstructionSet::AVX2:
+			return AVX2::NoiseGather(Out, Indices, Seeds, Num);
+		case EInstructionSet::SSE41:
+			return SSE41::NoiseGather(Out, Indices, Seeds, Num);
+#elif PLATFORM_CPU_ARM_FAMILY
+		case EInstructionSet::NEON:
+			return NEON::NoiseGather(Out, Indices, Seeds, Num);
+#endif
+		default:
+			return Scalar::NoiseGather(Out, Indices, Seeds, Num);
+		}
+	}
+}
+
+#undef SQUIRREL_TARGET_SSE41
+#undef SQUIRREL_TARGET_AVX2
@@ -0,0 +1,33 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Vectorized kernels that evaluate SquirrelNoise5 for many positions at once.
+ * Every kernel must produce output that is bit-identical to calling Raw::SquirrelNoise5 once per element, so that batch
+ * and single-value generation can be freely mixed without changing results for existing seeds.
+ */
+namespace Squirrel::Simd
+{
+	enum class EInstructionSet : uint8
+	{
+		Scalar,
+		SSE41,
+		AVX2,
+		NEON
+	};
+
+	// The instruction set the kernels dispatch to. Detected once, on first use.
+	EInstructionSet GetInstructionSet();
+
+	// Writes SquirrelNoise5(Start + i, Seed) for every i in [0, Num). Positions wrap around like FSquirrelState does.
+	void NoiseSequence(uint32* Out, int32 Num, int32 Start, uint32 Seed);
+
+	// Writes SquirrelNoise5(Indices[i], Seed) for every i in [0, Num).
+	void NoiseGather(uint32* Out, const int32* Indices, int32 Num, uint32 Seed);
+
+	// Writes SquirrelNoise5(Indices[i], Seeds[i]) for every i in [0, Num).
+	void NoiseGather(uint32* Out, const int32* Indices, const uint32* Seeds, int32 Num);
+}
@@ -0,0 +1,19 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FSquirrelFractalSettings;
+
+/*
+ * Single-threaded batch entry points to the coherent noise functions, for callers that already distribute their own work
+ * across threads. These produce the same output as the public SampleFractal functions.
+ */
+namespace Squirrel::Noise::Batch
+{
+	// Samples the X and Y components of each point.
+	void Fractal2D(const FSquirrelFractalSettings& Settings, uint32 Seed, const FVector* Points, int32 Num, double* Out);
+
+	void Fractal3D(const FSquirrelFractalSettings& Settings, uint32 Seed, const FVector* Points, int32 Num, double* Out);
+}
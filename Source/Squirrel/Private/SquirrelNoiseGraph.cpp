@@ -0,0 +1,556 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelNoiseGraph.h"
+#include "SquirrelNoise5.hpp"
+#include "SquirrelNoise5Simd.h"
+#include "SquirrelNoiseBatch.h"
+#include "Async/ParallelFor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(SquirrelNoiseGraph)
+
+#define LOCTEXT_NAMESPACE "SquirrelNoiseGraph"
+
+namespace Squirrel::NoiseGraph
+{
+	// Number of samples each instruction is run over before moving on to the next.
+	static constexpr int32 BatchSize = 256;
+
+	// The node inputs that an op reads. Scalar inputs are read from regular nodes, Position from a Warp node.
+	struct FNodeInputs
+	{
+		int32 Scalars[3] = { INDEX_NONE, INDEX_NONE, INDEX_NONE };
+		int32 NumScalars = 0;
+		bool bUsesPosition = false;
+	};
+
+	static FNodeInputs GetInputs(const FSquirrelNoiseGraphNode& Node, const ESquirrelNoiseGraphDimensions Dimensions)
+	{
+		FNodeInputs Inputs;
+		Inputs.Scalars[0] = Node.InputA;
+		Inputs.Scalars[1] = Node.InputB;
+		Inputs.Scalars[2] = Node.InputC;
+
+		switch (Node.Op)
+		{
+		case ESquirrelNoiseOp::Constant:
+			break;
+		case ESquirrelNoiseOp::Hash:
+		case ESquirrelNoiseOp::Noise:
+		case ESquirrelNoiseOp::Fractal:
+			Inputs.bUsesPosition = true;
+			break;
+		case ESquirrelNoiseOp::Warp:
+			Inputs.NumScalars = Dimensions == ESquirrelNoiseGraphDimensions::Three ? 3 : 2;
+			Inputs.bUsesPosition = true;
+			break;
+		case ESquirrelNoiseOp::Remap:
+			Inputs.NumScalars = 1;
+			break;
+		case ESquirrelNoiseOp::Add:
+		case ESquirrelNoiseOp::Multiply:
+		case ESquirrelNoiseOp::Min:
+		case ESquirrelNoiseOp::Max:
+			Inputs.NumScalars = 2;
+			break;
+		case ESquirrelNoiseOp::Blend:
+			Inputs.NumScalars = 3;
+			break;
+		}
+
+		return Inputs;
+	}
+
+	static FORCEINLINE uint32 NodeSeed(const uint32 Seed, const int32 SeedOffset)
+	{
+		return Raw::Get1dNoiseUint(SeedOffset, Seed);
+	}
+
+	// Noise nodes are single octave fractals.
+	static FSquirrelFractalSettings NoiseSettings(const FSquirrelFractalSettings& Settings)
+	{
+		FSquirrelFractalSettings Single = Settings;
+		Single.Type = ESquirrelFractalType::FBm;
+		Single.Octaves = 1;
+		return Single;
+	}
+
+	// Scale from Remap's input range to [0,1]. An empty input range maps everything to the start of the output range,
+	// instead of dividing by zero.
+	static FORCEINLINE double RemapInScale(const double InMin, const double InMax)
+	{
+		return InMax == InMin ? 0.0 : 1.0 / (InMax - InMin);
+	}
+
+	static FORCEINLINE int32 FloorToCell(const double Value, const double Frequency)
+	{
+		return static_cast<int32>(FMath::FloorToDouble(Value * Frequency));
+	}
+}
+
+void FSquirrelNoiseProgram::Evaluate(const uint32 Seed, const TConstArrayView<FVector> Points, const TArrayView<double> Out) const
+{
+	using namespace Squirrel::NoiseGraph;
+
+	check(Points.Num() == Out.Num());
+
+	ParallelFor(FMath::DivideAndRoundUp(Points.Num(), BatchSize),
+		[&](const int32 BatchIndex)
+		{
+			const int32 Start = BatchIndex * BatchSize;
+			const int32 Count = FMath::Min(BatchSize, Points.Num() - Start);
+			EvaluateBatch(Seed, Points.GetData() + Start, Count, Out.GetData() + Start);
+		});
+}
+
+void FSquirrelNoiseProgram::EvaluateBatch(const uint32 Seed, const FVector* Points, const int32 Num, double* Out) const
+{
+	using namespace Squirrel::NoiseGraph;
+
+	if (!IsValid())
+	{
+		FMemory::Memzero(Out, Num * sizeof(double));
+		return;
+	}
+
+	const bool bThreeD = Dimensions == ESquirrelNoiseGraphDimensions::Three;
+
+	TArray<double> ScalarRegisters;
+	ScalarRegisters.SetNumUninitialized(NumScalarRegisters * BatchSize);
+
+	// Position register 0 is the input points themselves, and is never allocated.
+	TArray<FVector> PositionRegisters;
+	PositionRegisters.SetNumUninitialized((NumPositionRegisters - 1) * BatchSize);
+
+	int32 Indices[BatchSize];
+	uint32 Hashes[BatchSize];
+
+	for (int32 Start = 0; Start < Num; Start += BatchSize)
+	{
+		const int32 Count = FMath::Min(BatchSize, Num - Start);
+
+		auto Scalar = [&](const uint16 Register) { return ScalarRegisters.GetData() + Register * BatchSize; };
+		auto Position = [&](const uint16 Register)
+		{
+			return Register == 0 ? const_cast<FVector*>(Points + Start) : PositionRegisters.GetData() + (Register - 1) * BatchSize;
+		};
+
+		for (const FSquirrelNoiseInstruction& Instruction : Instructions)
+		{
+			const double* A = Scalar(Instruction.A);
+			const double* B = Scalar(Instruction.B);
+			const double* C = Scalar(Instruction.C);
+			const FVector* P = Position(Instruction.Position);
+
+			if (Instruction.Op == ESquirrelNoiseOp::Warp)
+			{
+				FVector* Dest = Position(Instruction.Dest);
+				const double Strength = Instruction.Params[0];
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = P[i] + FVector(A[i], B[i], bThreeD ? C[i] : 0.0) * Strength;
+				}
+				continue;
+			}
+
+			double* Dest = Scalar(Instruction.Dest);
+
+			switch (Instruction.Op)
+			{
+			case ESquirrelNoiseOp::Constant:
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = Instruction.Params[0];
+				}
+				break;
+			case ESquirrelNoiseOp::Hash:
+			{
+				const double Frequency = Instruction.Fractal.Frequency;
+				for (int32 i = 0; i < Count; ++i)
+				{
+					uint32 Index = static_cast<uint32>(FloorToCell(P[i].X, Frequency));
+					Index += Squirrel::Raw::PRIME1 * static_cast<uint32>(FloorToCell(P[i].Y, Frequency));
+					if (bThreeD)
+					{
+						Index += Squirrel::Raw::PRIME2 * static_cast<uint32>(FloorToCell(P[i].Z, Frequency));
+					}
+					Indices[i] = static_cast<int32>(Index);
+				}
+
+				Squirrel::Simd::NoiseGather(Hashes, Indices, Count, NodeSeed(Seed, Instruction.SeedOffset));
+
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = Squirrel::Raw::ONE_OVER_MAX_INT * static_cast<double>(static_cast<int32>(Hashes[i]));
+				}
+				break;
+			}
+			case ESquirrelNoiseOp::Noise:
+			case ESquirrelNoiseOp::Fractal:
+			{
+				const uint32 InstructionSeed = NodeSeed(Seed, Instruction.SeedOffset);
+				if (bThreeD)
+				{
+					Squirrel::Noise::Batch::Fractal3D(Instruction.Fractal, InstructionSeed, P, Count, Dest);
+				}
+				else
+				{
+					Squirrel::Noise::Batch::Fractal2D(Instruction.Fractal, InstructionSeed, P, Count, Dest);
+				}
+				break;
+			}
+			case ESquirrelNoiseOp::Remap:
+			{
+				const double InMin = Instruction.Params[0];
+				const double InScale = RemapInScale(InMin, Instruction.Params[1]);
+				const double OutMin = Instruction.Params[2];
+				const double OutScale = Instruction.Params[3] - OutMin;
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = OutMin + (A[i] - InMin) * InScale * OutScale;
+				}
+				break;
+			}
+			case ESquirrelNoiseOp::Add:
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = A[i] + B[i];
+				}
+				break;
+			case ESquirrelNoiseOp::Multiply:
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = A[i] * B[i];
+				}
+				break;
+			case ESquirrelNoiseOp::Min:
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = FMath::Min(A[i], B[i]);
+				}
+				break;
+			case ESquirrelNoiseOp::Max:
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = FMath::Max(A[i], B[i]);
+				}
+				break;
+			case ESquirrelNoiseOp::Blend:
+				for (int32 i = 0; i < Count; ++i)
+				{
+					Dest[i] = FMath::Lerp(A[i], B[i], C[i]);
+				}
+				break;
+			default:
+				checkNoEntry();
+			}
+		}
+
+		FMemory::Memcpy(Out + Start, Scalar(OutputRegister), Count * sizeof(double));
+	}
+}
+
+void USquirrelNoiseGraph::PostLoad()
+{
+	Super::PostLoad();
+	Compile();
+}
+
+#if WITH_EDITOR
+void USquirrelNoiseGraph::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	Compile();
+}
+#endif
+
+int32 USquirrelNoiseGraph::GetOutputNode() const
+{
+	return OutputNode == INDEX_NONE ? Nodes.Num() - 1 : OutputNode;
+}
+
+bool USquirrelNoiseGraph::Compile(FText* OutError)
+{
+	using namespace Squirrel::NoiseGraph;
+
+	Program = MakeShared<FSquirrelNoiseProgram, ESPMode::ThreadSafe>();
+
+	auto Fail = [this, OutError](const FText& Error)
+	{
+		UE_LOG(LogSquirrel, Warning, TEXT("Failed to compile noise graph '%s': %s"), *GetName(), *Error.ToString());
+		if (OutError)
+		{
+			*OutError = Error;
+		}
+		return false;
+	};
+
+	const int32 Output = GetOutputNode();
+	if (!Nodes.IsValidIndex(Output))
+	{
+		return Fail(LOCTEXT("InvalidOutput", "The output node does not exist."));
+	}
+
+	if (Nodes[Output].Op == ESquirrelNoiseOp::Warp)
+	{
+		return Fail(LOCTEXT("WarpOutput", "The output node cannot be a Warp node."));
+	}
+
+	// Validate every node, and find which nodes contribute to the output.
+	TArray<bool> Live;
+	Live.Init(false, Nodes.Num());
+	Live[Output] = true;
+
+	TArray<int32> LastUse;
+	LastUse.Init(INDEX_NONE, Nodes.Num());
+	LastUse[Output] = MAX_int32;
+
+	for (int32 NodeIndex = Nodes.Num() - 1; NodeIndex >= 0; --NodeIndex)
+	{
+		const FSquirrelNoiseGraphNode& Node = Nodes[NodeIndex];
+		const FNodeInputs Inputs = GetInputs(Node, Dimensions);
+
+		for (int32 i = 0; i < Inputs.NumScalars; ++i)
+		{
+			const int32 Input = Inputs.Scalars[i];
+			if (Input < 0 || Input >= NodeIndex)
+			{
+				return Fail(FText::Format(LOCTEXT("InvalidInput", "Node {0} must take its inputs from earlier nodes."), NodeIndex));
+			}
+			if (Nodes[Input].Op == ESquirrelNoiseOp::Warp)
+			{
+				return Fail(FText::Format(LOCTEXT("WarpAsValue", "Node {0} cannot use a Warp node as a value input."), NodeIndex));
+			}
+		}
+
+		if (Inputs.bUsesPosition && Node.PositionInput != INDEX_NONE)
+		{
+			if (Node.PositionInput < 0 || Node.PositionInput >= NodeIndex || Nodes[Node.PositionInput].Op != ESquirrelNoiseOp::Warp)
+			{
+				return Fail(FText::Format(LOCTEXT("InvalidPosition", "Node {0} must take its position from an earlier Warp node."), NodeIndex));
+			}
+		}
+
+		if (!Live[NodeIndex])
+		{
+			continue;
+		}
+
+		for (int32 i = 0; i < Inputs.NumScalars; ++i)
+		{
+			Live[Inputs.Scalars[i]] = true;
+			LastUse[Inputs.Scalars[i]] = FMath::Max(LastUse[Inputs.Scalars[i]], NodeIndex);
+		}
+
+		if (Inputs.bUsesPosition && Node.PositionInput != INDEX_NONE)
+		{
+			Live[Node.PositionInput] = true;
+			LastUse[Node.PositionInput] = FMath::Max(LastUse[Node.PositionInput], NodeIndex);
+		}
+	}
+
+	// Emit instructions in node order, handing registers back as soon as the last node reading them has been emitted.
+	FSquirrelNoiseProgram Compiled;
+	Compiled.Dimensions = Dimensions;
+
+	TArray<uint16> Registers;
+	Registers.Init(0, Nodes.Num());
+
+	TArray<uint16> FreeScalars;
+	TArray<uint16> FreePositions;
+
+	for (int32 NodeIndex = 0; NodeIndex <= Output; ++NodeIndex)
+	{
+		if (!Live[NodeIndex])
+		{
+			continue;
+		}
+
+		const FSquirrelNoiseGraphNode& Node = Nodes[NodeIndex];
+		const FNodeInputs Inputs = GetInputs(Node, Dimensions);
+
+		FSquirrelNoiseInstruction& Instruction = Compiled.Instructions.AddDefaulted_GetRef();
+		Instruction.Op = Node.Op;
+		Instruction.SeedOffset = Node.SeedOffset;
+		Instruction.Fractal = Node.Op == ESquirrelNoiseOp::Noise ? NoiseSettings(Node.Fractal) : Node.Fractal;
+		Instruction.Params[0] = Node.Value;
+
+		if (Node.Op == ESquirrelNoiseOp::Remap)
+		{
+			Instruction.Params[0] = Node.InRange.X;
+			Instruction.Params[1] = Node.InRange.Y;
+			Instruction.Params[2] = Node.OutRange.X;
+			Instruction.Params[3] = Node.OutRange.Y;
+		}
+
+		uint16* Sources[3] = { &Instruction.A, &Instruction.B, &Instruction.C };
+		for (int32 i = 0; i < Inputs.NumScalars; ++i)
+		{
+			*Sources[i] = Registers[Inputs.Scalars[i]];
+		}
+
+		if (Inputs.bUsesPosition && Node.PositionInput != INDEX_NONE)
+		{
+			Instruction.Position = Registers[Node.PositionInput];
+		}
+
+		// Every op reads its inputs per-sample before writing, so inputs that die here can be reused as the destination.
+		auto Release = [&](const int32 Input)
+		{
+			if (LastUse[Input] == NodeIndex)
+			{
+				LastUse[Input] = INDEX_NONE;
+				(Nodes[Input].Op == ESquirrelNoiseOp::Warp ? FreePositions : FreeScalars).Push(Registers[Input]);
+			}
+		};
+
+		for (int32 i = 0; i < Inputs.NumScalars; ++i)
+		{
+			Release(Inputs.Scalars[i]);
+		}
+
+		if (Inputs.bUsesPosition && Node.PositionInput != INDEX_NONE)
+		{
+			Release(Node.PositionInput);
+		}
+
+		if (Node.Op == ESquirrelNoiseOp::Warp)
+		{
+			Registers[NodeIndex] = FreePositions.IsEmpty() ? static_cast<uint16>(Compiled.NumPositionRegisters++) : FreePositions.Pop(EAllowShrinking::No);
+		}
+		else
+		{
+			Registers[NodeIndex] = FreeScalars.IsEmpty() ? static_cast<uint16>(Compiled.NumScalarRegisters++) : FreeScalars.Pop(EAllowShrinking::No);
+		}
+
+		Instruction.Dest = Registers[NodeIndex];
+	}
+
+	if (Compiled.NumScalarRegisters > MAX_uint16 || Compiled.NumPositionRegisters > MAX_uint16)
+	{
+		return Fail(LOCTEXT("TooManyRegisters", "The graph is too large to compile."));
+	}
+
+	Compiled.OutputRegister = Registers[Output];
+
+	uint32 Hash = GetTypeHash(Compiled.Dimensions);
+	for (const FSquirrelNoiseInstruction& Instruction : Compiled.Instructions)
+	{
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.Op));
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.Dest));
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.A));
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.B));
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.C));
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.Position));
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.SeedOffset));
+		for (const double Param : Instruction.Params)
+		{
+			Hash = HashCombineFast(Hash, GetTypeHash(Param));
+		}
+		Hash = HashCombineFast(Hash, GetTypeHash(Instruction.Fractal));
+	}
+	Compiled.Hash = HashCombineFast(Hash, GetTypeHash(Compiled.OutputRegister));
+
+	Program = MakeShared<FSquirrelNoiseProgram, ESPMode::ThreadSafe>(MoveTemp(Compiled));
+	return true;
+}
+
+double USquirrelNoiseGraph::Evaluate(const FVector& Point, const int64 Seed) const
+{
+	double Result = 0.0;
+	Program->EvaluateBatch(static_cast<uint32>(Seed), &Point, 1, &Result);
+	return Result;
+}
+
+void USquirrelNoiseGraph::EvaluateBatch(const TArray<FVector>& Points, const int64 Seed, TArray<double>& Out) const
+{
+	Out.SetNumUninitialized(Points.Num());
+	Program->Evaluate(static_cast<uint32>(Seed), Points, Out);
+}
+
+double USquirrelNoiseGraph::EvaluateReference(const FVector& Point, const int64 Seed) const
+{
+	using namespace Squirrel::NoiseGraph;
+
+	if (!Program->IsValid())
+	{
+		return 0.0;
+	}
+
+	const uint32 GraphSeed = static_cast<uint32>(Seed);
+	const bool bThreeD = Dimensions == ESquirrelNoiseGraphDimensions::Three;
+	const int32 Output = GetOutputNode();
+
+	TArray<double> Values;
+	TArray<FVector> Positions;
+	Values.SetNumZeroed(Output + 1);
+	Positions.SetNumZeroed(Output + 1);
+
+	for (int32 NodeIndex = 0; NodeIndex <= Output; ++NodeIndex)
+	{
+		const FSquirrelNoiseGraphNode& Node = Nodes[NodeIndex];
+
+		// Only read the inputs Compile validated for this op. Others may hold stale indices left over from another op.
+		const FNodeInputs Inputs = GetInputs(Node, Dimensions);
+		double Scalars[3] = { 0.0, 0.0, 0.0 };
+		for (int32 i = 0; i < Inputs.NumScalars; ++i)
+		{
+			Scalars[i] = Values[Inputs.Scalars[i]];
+		}
+		const double A = Scalars[0];
+		const double B = Scalars[1];
+		const double C = Scalars[2];
+		const FVector P = Inputs.bUsesPosition && Node.PositionInput != INDEX_NONE ? Positions[Node.PositionInput] : Point;
+		const uint32 NodeSeedValue = NodeSeed(GraphSeed, Node.SeedOffset);
+
+		double& Value = Values[NodeIndex];
+
+		switch (Node.Op)
+		{
+		case ESquirrelNoiseOp::Constant:
+			Value = Node.Value;
+			break;
+		case ESquirrelNoiseOp::Hash:
+		{
+			const double Frequency = Node.Fractal.Frequency;
+			Value = bThreeD
+				? Squirrel::Raw::Get3dNoiseNegOneToOne(FloorToCell(P.X, Frequency), FloorToCell(P.Y, Frequency), FloorToCell(P.Z, Frequency), NodeSeedValue)
+				: Squirrel::Raw::Get2dNoiseNegOneToOne(FloorToCell(P.X, Frequency), FloorToCell(P.Y, Frequency), NodeSeedValue);
+			break;
+		}
+		case ESquirrelNoiseOp::Noise:
+		case ESquirrelNoiseOp::Fractal:
+		{
+			const FSquirrelFractalSettings Settings = Node.Op == ESquirrelNoiseOp::Noise ? NoiseSettings(Node.Fractal) : Node.Fractal;
+			Value = bThreeD
+				? Squirrel::Noise::Fractal3D(Settings, P, NodeSeedValue)
+				: Squirrel::Noise::Fractal2D(Settings, FVector2D(P.X, P.Y), NodeSeedValue);
+			break;
+		}
+		case ESquirrelNoiseOp::Warp:
+			Positions[NodeIndex] = P + FVector(A, B, bThreeD ? C : 0.0) * Node.Value;
+			break;
+		case ESquirrelNoiseOp::Remap:
+			Value = Node.OutRange.X + (A - Node.InRange.X) * RemapInScale(Node.InRange.X, Node.InRange.Y) * (Node.OutRange.Y - Node.OutRange.X);
+			break;
+		case ESquirrelNoiseOp::Add:
+			Value = A + B;
+			break;
+		case ESquirrelNoiseOp::Multiply:
+			Value = A * B;
+			break;
+		case ESquirrelNoiseOp::Min:
+			Value = FMath::Min(A, B);
+			break;
+		case ESquirrelNoiseOp::Max:
+			Value = FMath::Max(A, B);
+			break;
+		case ESquirrelNoiseOp::Blend:
+			Value = FMath::Lerp(A, B, C);
+			break;
+		}
+	}
+
+	return Values[Output];
+}
+
+#undef LOCTEXT_NAMESPACE
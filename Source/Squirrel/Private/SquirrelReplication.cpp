@@ -0,0 +1,58 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelReplication.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(SquirrelReplication)
+
+USquirrelSeedReplicationComponent::USquirrelSeedReplicationComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void USquirrelSeedReplicationComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USquirrelSeedReplicationComponent, WorldState);
+}
+
+void USquirrelSeedReplicationComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetOwner()->HasAuthority())
+	{
+		Synchronize();
+	}
+}
+
+void USquirrelSeedReplicationComponent::Synchronize()
+{
+	if (const USquirrelWorldSubsystem* Subsystem = UWorld::GetSubsystem<USquirrelWorldSubsystem>(GetWorld()))
+	{
+		WorldState = Subsystem->SaveWorldState();
+	}
+}
+
+void USquirrelSeedReplicationComponent::OnRep_WorldState()
+{
+	UWorld* World = GetWorld();
+	USquirrelWorldSubsystem* Subsystem = UWorld::GetSubsystem<USquirrelWorldSubsystem>(World);
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	// PIE worlds share the default context with the server's world.
+	if (World->WorldType == EWorldType::PIE && !Subsystem->HasIsolatedContext())
+	{
+		Subsystem->IsolateContext(WorldState.GlobalSeed);
+	}
+
+	Subsystem->LoadWorldState(WorldState);
+
+	UE_LOG(LogSquirrel, Log, TEXT("Received Squirrel seed %u, runtime position %d"), WorldState.GlobalSeed, WorldState.RuntimeState.Position);
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelScatter.h"
+#include "SquirrelNoise5.hpp"
+#include "Async/ParallelFor.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	Candidate placement and the phase order determine
+ *	the output of existing seeds.
+ */
+
+namespace Squirrel::Scatter
+{
+	// Cells are assigned to phases by their coordinate modulo this, on each axis.
+	static constexpr int32 PhasePeriod = 3;
+	static constexpr int32 NumPhases = PhasePeriod * PhasePeriod;
+
+	// With cells of Radius / sqrt(2), a point can only conflict with points in cells up to this far away.
+	static constexpr int32 ConflictCells = 2;
+
+	// Number of points handed to the sink at a time.
+	static constexpr int32 SinkBatchSize = 256;
+
+	static FORCEINLINE int32 PositiveMod(const int32 Value, const int32 Divisor)
+	{
+		return ((Value % Divisor) + Divisor) % Divisor;
+	}
+
+	/**
+	 * The accepted points of a rectangle of cells. Cells may only be written by the thread processing them, and only read
+	 * once the phase that writes them has completed.
+	 */
+	struct FCellGrid
+	{
+		FIntPoint Min;
+		FIntPoint Size;
+		TArray<FVector2D> Points;
+
+		// Not a bit array, as neighbouring cells are written from different threads.
+		TArray<bool> Occupied;
+
+		FCellGrid(const FIntPoint InMin, const FIntPoint InMax)
+		  : Min(InMin), Size(InMax - InMin + 1)
+		{
+			Points.SetNumUninitialized(Size.X * Size.Y);
+			Occupied.SetNumZeroed(Size.X * Size.Y);
+		}
+
+		int32 ToIndex(const int32 CellX, const int32 CellY) const
+		{
+			return (CellX - Min.X) + (CellY - Min.Y) * Size.X;
+		}
+	};
+
+	static void Generate(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, const FDensityMask* Mask, FPointSink OnPoints)
+	{
+		if (!Region.bIsValid || Settings.Radius <= 0.0 || Settings.CandidatesPerCell <= 0)
+		{
+			return;
+		}
+
+		const double CellSize = Settings.Radius * UE_DOUBLE_INV_SQRT_2;
+		const double RadiusSq = FMath::Square(Settings.Radius);
+
+		const FIntPoint RegionMin(FMath::FloorToInt32(Region.Min.X / CellSize), FMath::FloorToInt32(Region.Min.Y / CellSize));
+		const FIntPoint RegionMax(FMath::FloorToInt32(Region.Max.X / CellSize), FMath::FloorToInt32(Region.Max.Y / CellSize));
+		SQUIRREL_TRACE_BATCH(PoissonDisk, (RegionMax.X - RegionMin.X + 1) * (RegionMax.Y - RegionMin.Y + 1));
+
+		// A cell of the last phase depends on cells of earlier phases, which depend on their own neighbours, and so on.
+		// Each phase must be evaluated over a wider margin than the phases after it for the region's result to be exact.
+		auto PhaseMargin = [](const int32 Phase) { return ConflictCells * (NumPhases - 1 - Phase); };
+
+		// The outermost cells of the first phase still read their neighbours, which are simply left empty.
+		const int32 MaxMargin = PhaseMargin(0) + ConflictCells;
+		FCellGrid Grid(RegionMin - MaxMargin, RegionMax + MaxMargin);
+
+		for (int32 Phase = 0; Phase < NumPhases; ++Phase)
+		{
+			const int32 PhaseX = Phase % PhasePeriod;
+			const int32 PhaseY = Phase / PhasePeriod;
+			const int32 Margin = PhaseMargin(Phase);
+
+			// The first cell of this phase at or after the margin.
+			const FIntPoint First(
+				RegionMin.X - Margin + PositiveMod(PhaseX - (RegionMin.X - Margin), PhasePeriod),
+				RegionMin.Y - Margin + PositiveMod(PhaseY - (RegionMin.Y - Margin), PhasePeriod));
+			const FIntPoint Last = RegionMax + Margin;
+
+			if (First.X > Last.X || First.Y > Last.Y)
+			{
+				continue;
+			}
+
+			const int32 NumRows = (Last.Y - First.Y) / PhasePeriod + 1;
+			const int32 NumColumns = (Last.X - First.X) / PhasePeriod + 1;
+
+			ParallelFor(NumRows,
+				[&](const int32 Row)
+				{
+					const int32 CellY = First.Y + Row * PhasePeriod;
+
+					for (int32 Column = 0; Column < NumColumns; ++Column)
+					{
+						const int32 CellX = First.X + Column * PhasePeriod;
+						const uint32 CellHash = Raw::Get2dNoiseUint(CellX, CellY, Settings.Seed);
+
+						for (int32 Candidate = 0; Candidate < Settings.CandidatesPerCell; ++Candidate)
+						{
+							const FVector2D Location(
+								(CellX + Raw::ONE_OVER_MAX_UINT * Raw::Get1dNoiseUint(Candidate * 3, CellHash)) * CellSize,
+								(CellY + Raw::ONE_OVER_MAX_UINT * Raw::Get1dNoiseUint(Candidate * 3 + 1, CellHash)) * CellSize);
+
+							if (Mask && Raw::ONE_OVER_MAX_UINT * Raw::Get1dNoiseUint(Candidate * 3 + 2, CellHash) >= (*Mask)(Location))
+							{
+								continue;
+							}
+
+							bool bConflict = false;
+							for (int32 Y = CellY - ConflictCells; Y <= CellY + ConflictCells && !bConflict; ++Y)
+							{
+								for (int32 X = CellX - ConflictCells; X <= CellX + ConflictCells; ++X)
+								{
+									const int32 Neighbour = Grid.ToIndex(X, Y);
+									if (Grid.Occupied[Neighbour] && FVector2D::DistSquared(Grid.Points[Neighbour], Location) < RadiusSq)
+									{
+										bConflict = true;
+										break;
+									}
+								}
+							}
+
+							if (!bConflict)
+							{
+								const int32 Index = Grid.ToIndex(CellX, CellY);
+								Grid.Points[Index] = Location;
+								Grid.Occupied[Index] = true;
+								break;
+							}
+						}
+					}
+				});
+		}
+
+		// Hand back the points inside of the region, in cell order. The region is treated as half-open, so that a point on
+		// the shared edge of two adjacent regions is only returned by one of them.
+		auto InRegion = [&Region](const FVector2D& Point)
+		{
+			return Point.X >= Region.Min.X && Point.X < Region.Max.X && Point.Y >= Region.Min.Y && Point.Y < Region.Max.Y;
+		};
+
+		TArray<FVector2D, TInlineAllocator<SinkBatchSize>> Batch;
+
+		for (int32 CellY = RegionMin.Y; CellY <= RegionMax.Y; ++CellY)
+		{
+			for (int32 CellX = RegionMin.X; CellX <= RegionMax.X; ++CellX)
+			{
+				const int32 Index = Grid.ToIndex(CellX, CellY);
+				if (Grid.Occupied[Index] && InRegion(Grid.Points[Index]))
+				{
+					Batch.Add(Grid.Points[Index]);
+
+					if (Batch.Num() == SinkBatchSize)
+					{
+						SQUIRREL_COUNT(ScatteredPoints, Batch.Num());
+						OnPoints(Batch);
+						Batch.Reset();
+					}
+				}
+			}
+		}
+
+		if (!Batch.IsEmpty())
+		{
+			SQUIRREL_COUNT(ScatteredPoints, Batch.Num());
+			OnPoints(Batch);
+		}
+	}
+
+	void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, const FPointSink OnPoints)
+	{
+		Generate(Settings, Region, nullptr, OnPoints);
+	}
+
+	void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, const FDensityMask Mask, const FPointSink OnPoints)
+	{
+		Generate(Settings, Region, &Mask, OnPoints);
+	}
+
+	void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, TArray<FVector2D>& OutPoints)
+	{
+		Generate(Settings, Region, nullptr, [&OutPoints](const TConstArrayView<FVector2D> Points) { OutPoints.Append(Points); });
+	}
+
+	void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, const FDensityMask Mask, TArray<FVector2D>& OutPoints)
+	{
+		Generate(Settings, Region, &Mask, [&OutPoints](const TConstArrayView<FVector2D> Points) { OutPoints.Append(Points); });
+	}
+}
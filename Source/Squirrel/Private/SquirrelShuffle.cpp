@@ -0,0 +1,90 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelShuffle.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The order that positions are consumed in, and how
+ *	they are reduced into a range, determine the output
+ *	of existing seeds.
+ */
+
+namespace Squirrel
+{
+	namespace Impl
+	{
+		// Below this fraction of N, samples emulate the shuffle sparsely rather than building all N indices.
+		static constexpr int32 SparseSampleRatio = 8;
+	}
+
+	void SampleWithoutReplacement(FSquirrelState& State, int32 N, int32 K, TArray<int32>& Out)
+	{
+		N = FMath::Max(N, 0);
+		K = FMath::Clamp(K, 0, N);
+
+		SQUIRREL_TRACE_BATCH(SampleWithoutReplacement, K);
+		SQUIRREL_COUNT(ShuffledElements, K);
+
+		Out.SetNumUninitialized(K);
+
+		uint32 Noise[Impl::ShuffleChunkSize];
+
+		if (static_cast<int64>(K) * Impl::SparseSampleRatio < N)
+		{
+			// The value of every slot of the virtual index array that has been swapped away from its own index. Slot I is never
+			// read again once it has been output, as every later swap only touches slots after it.
+			TMap<int32, int32> Displaced;
+			Displaced.Reserve(K);
+
+			for (int32 Offset = 0; Offset < K; Offset += Impl::ShuffleChunkSize)
+			{
+				const int32 Count = FMath::Min(Impl::ShuffleChunkSize, K - Offset);
+				Fill(State, MakeArrayView(Noise, Count));
+
+				for (int32 k = 0; k < Count; ++k)
+				{
+					const int32 I = Offset + k;
+					const int32 J = I + Impl::ReduceToRange(Noise[k], N - I);
+
+					const int32* AtI = Displaced.Find(I);
+					const int32 ValueI = AtI ? *AtI : I;
+
+					if (I != J)
+					{
+						const int32* AtJ = Displaced.Find(J);
+						Out[I] = AtJ ? *AtJ : J;
+						Displaced.Add(J, ValueI);
+					}
+					else
+					{
+						Out[I] = ValueI;
+					}
+				}
+			}
+		}
+		else
+		{
+			TArray<int32> Indices;
+			Indices.SetNumUninitialized(N);
+			for (int32 i = 0; i < N; ++i)
+			{
+				Indices[i] = i;
+			}
+
+			for (int32 Offset = 0; Offset < K; Offset += Impl::ShuffleChunkSize)
+			{
+				const int32 Count = FMath::Min(Impl::ShuffleChunkSize, K - Offset);
+				Fill(State, MakeArrayView(Noise, Count));
+
+				for (int32 k = 0; k < Count; ++k)
+				{
+					const int32 I = Offset + k;
+					const int32 J = I + Impl::ReduceToRange(Noise[k], N - I);
+					Swap(Indices[I], Indices[J]);
+					Out[I] = Indices[I];
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,247 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelStateLibrary.h"
+#include "SquirrelGeometry.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(SquirrelStateLibrary)
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The array functions must consume positions and map
+ *	noise exactly as their single-value functions do.
+ */
+
+namespace Squirrel::StateLibrary
+{
+	// Number of values converted on the stack at a time.
+	static constexpr int32 ChunkSize = 256;
+
+	static FSquirrelContext& GetContext(const UObject* WorldContextObject)
+	{
+		if (const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr)
+		{
+			if (const USquirrelWorldSubsystem* Subsystem = World->GetSubsystem<USquirrelWorldSubsystem>();
+				Subsystem && Subsystem->HasIsolatedContext())
+			{
+				return Subsystem->GetContext();
+			}
+		}
+		return GetCurrentContext();
+	}
+
+	// Fill Out with Count values, each mapped from one NextReal.
+	template <typename T, typename MapType>
+	static void FillFromReals(FSquirrelState& State, const int32 Count, TArray<T>& Out, MapType&& Map)
+	{
+		Out.SetNumUninitialized(FMath::Max(Count, 0));
+
+		double Reals[ChunkSize];
+
+		for (int32 Offset = 0; Offset < Out.Num(); Offset += ChunkSize)
+		{
+			const int32 Num = FMath::Min(ChunkSize, Out.Num() - Offset);
+			Fill(State, MakeArrayView(Reals, Num));
+
+			T* Dest = Out.GetData() + Offset;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Dest[i] = Map(Reals[i]);
+			}
+		}
+	}
+
+	static void FillInt32(FSquirrelState& State, const int32 Count, const int32 Max, TArray<int32>& Out)
+	{
+		// NextInt32 doesn't consume a position when Max is not positive.
+		if (Max <= 0)
+		{
+			Out.Init(0, FMath::Max(Count, 0));
+			return;
+		}
+
+		FillFromReals(State, Count, Out,
+			[Max](const double Real) { return FMath::Min(FMath::TruncToInt(Real * static_cast<double>(Max)), Max - 1); });
+	}
+}
+
+FSquirrelState USquirrelStateLibrary::MakeSquirrelState(const int32 Position)
+{
+	return FSquirrelState{ Position };
+}
+
+FSquirrelState USquirrelStateLibrary::NewSquirrelState(const UObject* WorldContextObject)
+{
+	return FSquirrelState{ Squirrel::StateLibrary::GetContext(WorldContextObject).NewPosition() };
+}
+
+int32 USquirrelStateLibrary::GetPosition(const FSquirrelState& State)
+{
+	return State.Position;
+}
+
+void USquirrelStateLibrary::Jump(FSquirrelState& State, const int32 NewPosition)
+{
+	State.Position = NewPosition;
+}
+
+int32 USquirrelStateLibrary::NextInt32(const UObject* WorldContextObject, FSquirrelState& State, const int32 Max)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::NextInt32(State, Max);
+}
+
+int32 USquirrelStateLibrary::NextInt32InRange(const UObject* WorldContextObject, FSquirrelState& State, const int32 Min, const int32 Max)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::NextInt32InRange(State, Min, Max);
+}
+
+bool USquirrelStateLibrary::NextBool(const UObject* WorldContextObject, FSquirrelState& State)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::Next<bool>(State);
+}
+
+double USquirrelStateLibrary::NextReal(const UObject* WorldContextObject, FSquirrelState& State)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::NextReal(State);
+}
+
+double USquirrelStateLibrary::NextRealInRange(const UObject* WorldContextObject, FSquirrelState& State, const double Min, const double Max)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::NextRealInRange(State, Min, Max);
+}
+
+bool USquirrelStateLibrary::RollChance(const UObject* WorldContextObject, FSquirrelState& State, double& Roll, const double Chance,
+	const double RollModifier)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::RollChance(State, Roll, Chance, RollModifier);
+}
+
+int32 USquirrelStateLibrary::RoundWithWeightByFraction(const UObject* WorldContextObject, FSquirrelState& State, const double Value)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::RoundWithWeightByFraction(State, Value);
+}
+
+FSquirrelState USquirrelStateLibrary::Split(const UObject* WorldContextObject, const FSquirrelState& State, const int32 Index)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	return Squirrel::Split(State, Index);
+}
+
+void USquirrelStateLibrary::SplitArray(const UObject* WorldContextObject, const FSquirrelState& State, const int32 Count,
+	TArray<FSquirrelState>& OutStates)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	OutStates.SetNum(FMath::Max(Count, 0));
+	Squirrel::Split(State, OutStates);
+}
+
+void USquirrelStateLibrary::NextInt32Array(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, const int32 Max,
+	TArray<int32>& OutValues)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	Squirrel::StateLibrary::FillInt32(State, Count, Max, OutValues);
+}
+
+void USquirrelStateLibrary::NextInt32InRangeArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, const int32 Min,
+	const int32 Max, TArray<int32>& OutValues)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+
+	// Same range as NextInt32InRange, including its limits.
+	Squirrel::StateLibrary::FillInt32(State, Count, (Max - Min) + 1, OutValues);
+	for (int32& Value : OutValues)
+	{
+		Value += Min;
+	}
+}
+
+void USquirrelStateLibrary::NextBoolArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, TArray<bool>& OutValues)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+
+	OutValues.SetNumUninitialized(FMath::Max(Count, 0));
+
+	uint32 Noise[Squirrel::StateLibrary::ChunkSize];
+
+	for (int32 Offset = 0; Offset < OutValues.Num(); Offset += Squirrel::StateLibrary::ChunkSize)
+	{
+		const int32 Num = FMath::Min(Squirrel::StateLibrary::ChunkSize, OutValues.Num() - Offset);
+		Squirrel::Fill(State, MakeArrayView(Noise, Num));
+
+		for (int32 i = 0; i < Num; ++i)
+		{
+			OutValues[Offset + i] = !!(Noise[i] % 2);
+		}
+	}
+}
+
+void USquirrelStateLibrary::NextRealArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, TArray<double>& OutValues)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	OutValues.SetNumUninitialized(FMath::Max(Count, 0));
+	Squirrel::Fill(State, MakeArrayView(OutValues));
+}
+
+void USquirrelStateLibrary::NextRealInRangeArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, const double Min,
+	const double Max, TArray<double>& OutValues)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	Squirrel::StateLibrary::FillFromReals(State, Count, OutValues,
+		[Min, Max](const double Real) { return Min + (Max - Min) * Real; });
+}
+
+void USquirrelStateLibrary::RollChanceArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, const double Chance,
+	const double RollModifier, TArray<double>& OutRolls, TArray<bool>& OutSuccesses)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+
+	// The same arithmetic as RollChance, which rolls NextRealInRange(0, 100 - RollModifier).
+	const double Max = 100.0 - RollModifier;
+	Squirrel::StateLibrary::FillFromReals(State, Count, OutRolls,
+		[Max, RollModifier](const double Real) { return (0.0 + (Max - 0.0) * Real) + RollModifier; });
+
+	OutSuccesses.SetNumUninitialized(OutRolls.Num());
+	for (int32 i = 0; i < OutRolls.Num(); ++i)
+	{
+		OutSuccesses[i] = OutRolls[i] >= Chance;
+	}
+}
+
+void USquirrelStateLibrary::NextUnitVectorArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, TArray<FVector>& OutVectors)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	OutVectors.SetNumUninitialized(FMath::Max(Count, 0));
+	Squirrel::FillUnitVectors(State, OutVectors);
+}
+
+void USquirrelStateLibrary::NextPointInBoxArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, const FBox& Box,
+	TArray<FVector>& OutPoints)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	OutPoints.SetNumUninitialized(FMath::Max(Count, 0));
+	Squirrel::FillPointsInBox(State, Box, OutPoints);
+}
+
+void USquirrelStateLibrary::NextPointInSphereArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, const double Radius,
+	TArray<FVector>& OutPoints)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	OutPoints.SetNumUninitialized(FMath::Max(Count, 0));
+	Squirrel::FillPointsInSphere(State, Radius, OutPoints);
+}
+
+void USquirrelStateLibrary::NextRotatorArray(const UObject* WorldContextObject, FSquirrelState& State, const int32 Count, TArray<FRotator>& OutRotators)
+{
+	FSquirrelContextScope Scope(Squirrel::StateLibrary::GetContext(WorldContextObject));
+	OutRotators.SetNumUninitialized(FMath::Max(Count, 0));
+	Squirrel::FillRotators(State, OutRotators);
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelStateRegistry.h"
+
+FSquirrelStateRegistry::FSquirrelStateRegistry(const int32 InCapacity, const int32 InNumFrames)
+{
+	check(InCapacity > 0 && InNumFrames > 0);
+
+	const int32 NumWords = FMath::DivideAndRoundUp(FMath::DivideAndRoundUp(InCapacity, StatesPerBlock), 64);
+
+	States.SetNumZeroed(InCapacity);
+	Registered.Init(false, InCapacity);
+
+	FreeIndices.Reserve(InCapacity);
+	for (int32 i = InCapacity - 1; i >= 0; --i)
+	{
+		FreeIndices.Add(i);
+	}
+
+	Snapshots.SetNumZeroed(InCapacity * InNumFrames);
+	Slots.SetNum(InNumFrames);
+	for (FFrameSlot& Slot : Slots)
+	{
+		Slot.Changes.SetNumZeroed(NumWords);
+		Slot.Stale.SetNumZeroed(NumWords);
+	}
+
+	CurrentChanges.SetNumZeroed(NumWords);
+	BlocksToCopy.SetNumZeroed(NumWords);
+}
+
+FSquirrelStateHandle FSquirrelStateRegistry::Register(const FSquirrelState InitialState)
+{
+	if (FreeIndices.IsEmpty())
+	{
+		return FSquirrelStateHandle();
+	}
+
+	const int32 Index = FreeIndices.Pop(EAllowShrinking::No);
+	Registered[Index] = true;
+	++NumRegistered;
+
+	const FSquirrelStateHandle Handle{ Index };
+	Edit(Handle) = InitialState;
+	return Handle;
+}
+
+void FSquirrelStateRegistry::Unregister(const FSquirrelStateHandle Handle)
+{
+	if (Handle.IsValid() && Registered[Handle.Index])
+	{
+		Registered[Handle.Index] = false;
+		FreeIndices.Add(Handle.Index);
+		--NumRegistered;
+	}
+}
+
+void FSquirrelStateRegistry::SaveFrame(const int32 Frame)
+{
+	if (!ensureMsgf(Frame >= 0 && Frame > LastSavedFrame, TEXT("Frame %d cannot be saved after frame %d"), Frame, LastSavedFrame))
+	{
+		return;
+	}
+
+	FFrameSlot& Slot = Slots[GetSlotIndex(Frame)];
+	FSquirrelState* Snapshot = GetSnapshot(GetSlotIndex(Frame));
+
+	// The slot already holds an older frame, so only the blocks changed since then need to be copied.
+	const int32 BaseFrame = Slot.Frame != INDEX_NONE ? Slot.Frame : Slot.BaseFrame;
+	bool bIncremental = false;
+
+	if (BaseFrame != INDEX_NONE && LastSavedFrame != INDEX_NONE)
+	{
+		BlocksToCopy = CurrentChanges;
+		if (Slot.Frame == INDEX_NONE)
+		{
+			for (int32 Word = 0; Word < BlocksToCopy.Num(); ++Word)
+			{
+				BlocksToCopy[Word] |= Slot.Stale[Word];
+			}
+		}
+		bIncremental = AddChangesSince(BaseFrame, BlocksToCopy);
+	}
+
+	if (bIncremental)
+	{
+		LastCopyCount = CopyBlocks(BlocksToCopy, States.GetData(), Snapshot);
+	}
+	else
+	{
+		FMemory::Memcpy(Snapshot, States.GetData(), States.Num() * sizeof(FSquirrelState));
+		LastCopyCount = States.Num();
+	}
+
+	Slot.Frame = Frame;
+	Slot.PreviousFrame = LastSavedFrame;
+	Slot.Changes = CurrentChanges;
+	Slot.BaseFrame = INDEX_NONE;
+	FMemory::Memzero(Slot.Stale.GetData(), Slot.Stale.Num() * sizeof(uint64));
+
+	FMemory::Memzero(CurrentChanges.GetData(), CurrentChanges.Num() * sizeof(uint64));
+	LastSavedFrame = Frame;
+}
+
+bool FSquirrelStateRegistry::RestoreFrame(const int32 Frame)
+{
+	if (!HasFrame(Frame))
+	{
+		return false;
+	}
+
+	const FSquirrelState* Snapshot = GetSnapshot(GetSlotIndex(Frame));
+
+	BlocksToCopy = CurrentChanges;
+	const bool bIncremental = AddChangesSince(Frame, BlocksToCopy);
+
+	if (bIncremental)
+	{
+		LastCopyCount = CopyBlocks(BlocksToCopy, Snapshot, States.GetData());
+
+		// The contents of the discarded frames still match the restored frame, except for the blocks changed since it.
+		TArray<int32, TInlineAllocator<16>> Discarded;
+		for (int32 Saved = LastSavedFrame; Saved > Frame; Saved = Slots[GetSlotIndex(Saved)].PreviousFrame)
+		{
+			Discarded.Add(GetSlotIndex(Saved));
+		}
+
+		FMemory::Memzero(BlocksToCopy.GetData(), BlocksToCopy.Num() * sizeof(uint64));
+		for (int32 i = Discarded.Num() - 1; i >= 0; --i)
+		{
+			FFrameSlot& Slot = Slots[Discarded[i]];
+			for (int32 Word = 0; Word < BlocksToCopy.Num(); ++Word)
+			{
+				BlocksToCopy[Word] |= Slot.Changes[Word];
+			}
+
+			Slot.Frame = INDEX_NONE;
+			Slot.BaseFrame = Frame;
+			Slot.Stale = BlocksToCopy;
+		}
+	}
+	else
+	{
+		FMemory::Memcpy(States.GetData(), Snapshot, States.Num() * sizeof(FSquirrelState));
+		LastCopyCount = States.Num();
+	}
+
+	// Anything that is still relative to a discarded frame can no longer be saved over incrementally.
+	for (FFrameSlot& Slot : Slots)
+	{
+		if (Slot.Frame > Frame || Slot.BaseFrame > Frame)
+		{
+			Slot.Frame = INDEX_NONE;
+			Slot.BaseFrame = INDEX_NONE;
+		}
+	}
+
+	FMemory::Memzero(CurrentChanges.GetData(), CurrentChanges.Num() * sizeof(uint64));
+	LastSavedFrame = Frame;
+	return true;
+}
+
+bool FSquirrelStateRegistry::HasFrame(const int32 Frame) const
+{
+	return Frame >= 0 && Frame <= LastSavedFrame && Slots[GetSlotIndex(Frame)].Frame == Frame;
+}
+
+void FSquirrelStateRegistry::GetDirtyRanges(TArray<FRange>& OutRanges) const
+{
+	OutRanges.Reset();
+	ForEachRange(CurrentChanges, [&OutRanges](const int32 First, const int32 Num) { OutRanges.Add(FRange{ First, Num }); });
+}
+
+bool FSquirrelStateRegistry::AddChangesSince(const int32 AfterFrame, TArray<uint64>& Blocks) const
+{
+	// Walk back through the saved frames. Frames that were skipped have no changes of their own; they were saved with the
+	// next frame.
+	int32 Frame = LastSavedFrame;
+	while (Frame > AfterFrame)
+	{
+		const FFrameSlot& Slot = Slots[GetSlotIndex(Frame)];
+		if (Slot.Frame != Frame)
+		{
+			return false;
+		}
+
+		for (int32 Word = 0; Word < Blocks.Num(); ++Word)
+		{
+			Blocks[Word] |= Slot.Changes[Word];
+		}
+		Frame = Slot.PreviousFrame;
+	}
+	return Frame == AfterFrame;
+}
+
+template <typename FuncType>
+void FSquirrelStateRegistry::ForEachRange(const TArray<uint64>& Blocks, FuncType&& Func) const
+{
+	const int32 NumBlocks = FMath::DivideAndRoundUp(States.Num(), StatesPerBlock);
+
+	int32 RunStart = INDEX_NONE;
+	for (int32 Block = 0; Block <= NumBlocks; ++Block)
+	{
+		const bool bMarked = Block < NumBlocks && (Blocks[Block / 64] >> (Block % 64)) & 1;
+
+		if (bMarked && RunStart == INDEX_NONE)
+		{
+			RunStart = Block;
+		}
+		else if (!bMarked && RunStart != INDEX_NONE)
+		{
+			const int32 First = RunStart * StatesPerBlock;
+			Func(First, FMath::Min(Block * StatesPerBlock, States.Num()) - First);
+			RunStart = INDEX_NONE;
+		}
+
+		// Skip over empty words.
+		if (RunStart == INDEX_NONE && Block % 64 == 0 && Block < NumBlocks && Blocks[Block / 64] == 0)
+		{
+			Block += 63;
+		}
+	}
+}
+
+int32 FSquirrelStateRegistry::CopyBlocks(const TArray<uint64>& Blocks, const FSquirrelState* From, FSquirrelState* To) const
+{
+	int32 Copied = 0;
+	ForEachRange(Blocks,
+		[From, To, &Copied](const int32 First, const int32 Num)
+		{
+			FMemory::Memcpy(To + First, From + First, Num * sizeof(FSquirrelState));
+			Copied += Num;
+		});
+	return Copied;
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelStats.h"
+#include "Squirrel.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "UObject/UObjectIterator.h"
+
+#if SQUIRREL_INSTRUMENTATION
+
+UE_TRACE_CHANNEL_DEFINE(SquirrelChannel)
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scalar Draws"), STAT_SquirrelNext, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batch Draws"), STAT_SquirrelFill, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Runtime Positions"), STAT_SquirrelNewPosition, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Distribution Samples"), STAT_SquirrelDistributionSamples, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weighted Samples"), STAT_SquirrelWeightedSamples, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shuffled Elements"), STAT_SquirrelShuffledElements, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Samples"), STAT_SquirrelNoiseSamples, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cellular Samples"), STAT_SquirrelCellularSamples, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Grid Cells"), STAT_SquirrelGridCells, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scattered Points"), STAT_SquirrelScatteredPoints, STATGROUP_Squirrel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Low-Discrepancy Points"), STAT_SquirrelLowDiscrepancyPoints, STATGROUP_Squirrel);
+
+TRACE_DECLARE_INT_COUNTER(SquirrelNext, TEXT("Squirrel/Scalar Draws"));
+TRACE_DECLARE_INT_COUNTER(SquirrelFill, TEXT("Squirrel/Batch Draws"));
+TRACE_DECLARE_INT_COUNTER(SquirrelNewPosition, TEXT("Squirrel/Runtime Positions"));
+TRACE_DECLARE_INT_COUNTER(SquirrelDistributionSamples, TEXT("Squirrel/Distribution Samples"));
+TRACE_DECLARE_INT_COUNTER(SquirrelWeightedSamples, TEXT("Squirrel/Weighted Samples"));
+TRACE_DECLARE_INT_COUNTER(SquirrelShuffledElements, TEXT("Squirrel/Shuffled Elements"));
+TRACE_DECLARE_INT_COUNTER(SquirrelNoiseSamples, TEXT("Squirrel/Noise Samples"));
+TRACE_DECLARE_INT_COUNTER(SquirrelCellularSamples, TEXT("Squirrel/Cellular Samples"));
+TRACE_DECLARE_INT_COUNTER(SquirrelGridCells, TEXT("Squirrel/Grid Cells"));
+TRACE_DECLARE_INT_COUNTER(SquirrelScatteredPoints, TEXT("Squirrel/Scattered Points"));
+TRACE_DECLARE_INT_COUNTER(SquirrelLowDiscrepancyPoints, TEXT("Squirrel/Low-Discrepancy Points"));
+
+namespace Squirrel::Stats
+{
+	bool GEnabled = false;
+	bool GPerObjectEnabled = false;
+	std::atomic<uint64> GCounters[static_cast<int32>(ECounter::Num)];
+
+	static FAutoConsoleVariableRef CVarSquirrelStats(
+		TEXT("Squirrel.Stats"),
+		GEnabled,
+		TEXT("Count the positions consumed by each Squirrel API, for \"stat Squirrel\" and the Squirrel counters in Insights."));
+
+	static FAutoConsoleVariableRef CVarSquirrelStatsPerObject(
+		TEXT("Squirrel.Stats.PerObject"),
+		GPerObjectEnabled,
+		TEXT("Total the positions consumed through each USquirrel. List the totals with Squirrel.Stats.DumpObjects."));
+
+	static FAutoConsoleCommand CmdSquirrelStatsDumpObjects(
+		TEXT("Squirrel.Stats.DumpObjects"),
+		TEXT("Log the USquirrels that consumed the most positions while Squirrel.Stats.PerObject was enabled. Usage: Squirrel.Stats.DumpObjects [Count]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			int32 Count = 20;
+			if (Args.IsValidIndex(0))
+			{
+				LexFromString(Count, *Args[0]);
+			}
+
+			TArray<const USquirrel*> Squirrels;
+			for (TObjectIterator<USquirrel> It; It; ++It)
+			{
+				if (It->GetDrawTotal() > 0)
+				{
+					Squirrels.Add(*It);
+				}
+			}
+
+			Squirrels.Sort([](const USquirrel& A, const USquirrel& B) { return A.GetDrawTotal() > B.GetDrawTotal(); });
+
+			UE_LOG(LogSquirrel, Display, TEXT("%d of %d Squirrels with draws:"), FMath::Min(Count, Squirrels.Num()), Squirrels.Num());
+			for (int32 i = 0; i < Squirrels.Num() && i < Count; ++i)
+			{
+				UE_LOG(LogSquirrel, Display, TEXT("  %12llu  %s"), Squirrels[i]->GetDrawTotal(), *Squirrels[i]->GetPathName());
+			}
+		}));
+
+	static uint64 Take(const ECounter Counter)
+	{
+		return GCounters[static_cast<int32>(Counter)].exchange(0, std::memory_order_relaxed);
+	}
+
+	void Publish()
+	{
+		if (!GEnabled)
+		{
+			return;
+		}
+
+#define SQUIRREL_PUBLISH_COUNTER(Counter) \
+		{ \
+			const uint64 Value = Take(ECounter::Counter); \
+			SET_DWORD_STAT(STAT_Squirrel##Counter, static_cast<uint32>(FMath::Min<uint64>(Value, MAX_uint32))); \
+			TRACE_COUNTER_SET(Squirrel##Counter, static_cast<int64>(Value)); \
+		}
+
+		SQUIRREL_PUBLISH_COUNTER(Next)
+		SQUIRREL_PUBLISH_COUNTER(Fill)
+		SQUIRREL_PUBLISH_COUNTER(NewPosition)
+		SQUIRREL_PUBLISH_COUNTER(DistributionSamples)
+		SQUIRREL_PUBLISH_COUNTER(WeightedSamples)
+		SQUIRREL_PUBLISH_COUNTER(ShuffledElements)
+		SQUIRREL_PUBLISH_COUNTER(NoiseSamples)
+		SQUIRREL_PUBLISH_COUNTER(CellularSamples)
+		SQUIRREL_PUBLISH_COUNTER(GridCells)
+		SQUIRREL_PUBLISH_COUNTER(ScatteredPoints)
+		SQUIRREL_PUBLISH_COUNTER(LowDiscrepancyPoints)
+
+#undef SQUIRREL_PUBLISH_COUNTER
+	}
+
+	FObjectDrawScope::FObjectDrawScope(USquirrel& InObject)
+	  : Object(GPerObjectEnabled ? &InObject : nullptr),
+		StartPosition(InObject.State.Position)
+	{
+	}
+
+	FObjectDrawScope::~FObjectDrawScope()
+	{
+		if (Object)
+		{
+			// Positions only ever move forward through the object's functions, except for Jump, which isn't tracked.
+			Object->DrawTotal += static_cast<uint32>(Object->State.Position) - static_cast<uint32>(StartPosition);
+		}
+	}
+}
+
+#endif
\ No newline at end of file
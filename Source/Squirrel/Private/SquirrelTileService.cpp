@@ -0,0 +1,364 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelTileService.h"
+#include "SquirrelNoiseBatch.h"
+#include "SquirrelNoiseGraph.h"
+#include "Tasks/Task.h"
+
+// Upper bound on the number of cached tiles, in addition to the memory budget.
+static constexpr int32 MaxCachedTiles = 16384;
+
+struct FSquirrelTileService::FJob
+{
+	FSquirrelTileKey Key;
+	int32 TileSize = 0;
+	double SampleSpacing = 1.0;
+	FSquirrelFractalSettings Fractal;
+	TSharedPtr<const FSquirrelNoiseProgram, ESPMode::ThreadSafe> Program;
+
+	// World-space center of the tile, used to prioritize it.
+	FVector2D Center = FVector2D::ZeroVector;
+
+	// Requests waiting on this tile, by handle.
+	TMap<uint64, FOnSquirrelTileReady> Requests;
+
+	FSquirrelNoiseTilePtr Result;
+};
+
+uint32 FSquirrelTileConfig::GetHash() const
+{
+	uint32 Hash = HashCombineFast(GetTypeHash(TileSize), GetTypeHash(SampleSpacing));
+	return HashCombineFast(Hash, Graph ? Graph->GetProgram().GetHash() : GetTypeHash(Fractal));
+}
+
+FSquirrelTileKey::FSquirrelTileKey(const FSquirrelTileConfig& Config, const uint32 InSeed, const FIntPoint InCoord)
+  : Seed(InSeed),
+	Coord(InCoord),
+	TileSize(Config.TileSize),
+	SampleSpacing(Config.SampleSpacing),
+	ConfigHash(Config.GetHash())
+{
+	if (Config.Graph)
+	{
+		Program = Config.Graph->GetProgramRef();
+	}
+	else
+	{
+		Fractal = Config.Fractal;
+	}
+}
+
+FSquirrelTileService::FSquirrelTileService(const SIZE_T InMaxCacheBytes)
+  : Cache(MaxCachedTiles),
+	MaxCacheBytes(InMaxCacheBytes),
+	MaxWorkers(FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() / 2))
+{
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSquirrelTileService::Tick));
+}
+
+FSquirrelTileService::~FSquirrelTileService()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	TArray<UE::Tasks::FTask> RunningWorkers;
+	{
+		FScopeLock ScopeLock(&Lock);
+		bShuttingDown = true;
+		Pending.Empty();
+		RunningWorkers = MoveTemp(Workers);
+	}
+
+	UE::Tasks::Wait(RunningWorkers);
+}
+
+FSquirrelNoiseTilePtr FSquirrelTileService::FindTile(const FSquirrelTileConfig& Config, const uint32 Seed, const FIntPoint Coord)
+{
+	const FSquirrelTileKey Key(Config, Seed, Coord);
+
+	FScopeLock ScopeLock(&Lock);
+	if (const FSquirrelNoiseTilePtr* Found = Cache.FindAndTouch(Key))
+	{
+		Stats.Hits++;
+		return *Found;
+	}
+	return nullptr;
+}
+
+uint64 FSquirrelTileService::RequestTile(const FSquirrelTileConfig& Config, const uint32 Seed, const FIntPoint Coord, FOnSquirrelTileReady OnReady)
+{
+	check(Config.TileSize > 0);
+
+	const FSquirrelTileKey Key(Config, Seed, Coord);
+
+	FSquirrelNoiseTilePtr Cached;
+	uint64 Handle = 0;
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		if (const FSquirrelNoiseTilePtr* Found = Cache.FindAndTouch(Key))
+		{
+			Stats.Hits++;
+			Cached = *Found;
+		}
+		else
+		{
+			Stats.Misses++;
+			Handle = NextRequestHandle++;
+
+			TSharedRef<FJob>* Existing = Jobs.Find(Key);
+			if (!Existing)
+			{
+				TSharedRef<FJob> Job = MakeShared<FJob>();
+				Job->Key = Key;
+				Job->TileSize = Config.TileSize;
+				Job->SampleSpacing = Config.SampleSpacing;
+				Job->Fractal = Key.Fractal;
+				Job->Program = Key.Program;
+				Job->Center = (FVector2D(Coord) + 0.5) * (Config.TileSize * Config.SampleSpacing);
+
+				Existing = &Jobs.Add(Key, Job);
+				Pending.Add(Job);
+			}
+
+			(*Existing)->Requests.Add(Handle, MoveTemp(OnReady));
+			RequestKeys.Add(Handle, Key);
+		}
+	}
+
+	if (Cached)
+	{
+		OnReady.ExecuteIfBound(Cached);
+		return 0;
+	}
+
+	LaunchWorkers();
+	return Handle;
+}
+
+void FSquirrelTileService::CancelRequest(const uint64 Handle)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FSquirrelTileKey Key;
+	if (!RequestKeys.RemoveAndCopyValue(Handle, Key))
+	{
+		return;
+	}
+
+	if (const TSharedRef<FJob>* Job = Jobs.Find(Key))
+	{
+		(*Job)->Requests.Remove(Handle);
+
+		// Only jobs that haven't started can be dropped. Running jobs finish, and their tile is still cached.
+		if ((*Job)->Requests.IsEmpty() && Pending.Contains(*Job))
+		{
+			CancelJob(*Job);
+		}
+		return;
+	}
+
+	// The tile may have been generated, but not delivered yet.
+	for (const TSharedRef<FJob>& Job : Completed)
+	{
+		if (Job->Key == Key)
+		{
+			Job->Requests.Remove(Handle);
+			return;
+		}
+	}
+}
+
+void FSquirrelTileService::SetFocus(const FVector2D& WorldPosition, const double CancelDistance)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	Focus = WorldPosition;
+
+	const double CancelDistanceSq = CancelDistance < TNumericLimits<double>::Max() ? FMath::Square(CancelDistance) : TNumericLimits<double>::Max();
+
+	for (int32 i = Pending.Num() - 1; i >= 0; --i)
+	{
+		if (FVector2D::DistSquared(Pending[i]->Center, Focus) > CancelDistanceSq)
+		{
+			CancelJob(Pending[i]);
+		}
+	}
+}
+
+void FSquirrelTileService::SetMaxCacheBytes(const SIZE_T InMaxCacheBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+	MaxCacheBytes = InMaxCacheBytes;
+	EvictToBudget();
+}
+
+void FSquirrelTileService::EmptyCache()
+{
+	FScopeLock ScopeLock(&Lock);
+	Cache.Empty(MaxCachedTiles);
+	CachedBytes = 0;
+}
+
+FSquirrelTileServiceStats FSquirrelTileService::GetStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FSquirrelTileServiceStats Current = Stats;
+	Current.CachedBytes = CachedBytes;
+	Current.CachedTiles = Cache.Num();
+	Current.PendingTiles = Jobs.Num();
+	return Current;
+}
+
+bool FSquirrelTileService::Tick(float DeltaTime)
+{
+	TArray<TSharedRef<FJob>> Finished;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Finished = MoveTemp(Completed);
+
+		for (const TSharedRef<FJob>& Job : Finished)
+		{
+			for (const TPair<uint64, FOnSquirrelTileReady>& Request : Job->Requests)
+			{
+				RequestKeys.Remove(Request.Key);
+			}
+		}
+	}
+
+	for (const TSharedRef<FJob>& Job : Finished)
+	{
+		for (TPair<uint64, FOnSquirrelTileReady>& Request : Job->Requests)
+		{
+			Request.Value.ExecuteIfBound(Job->Result);
+		}
+	}
+
+	return true;
+}
+
+void FSquirrelTileService::LaunchWorkers()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// Forget about workers that have already exited.
+	Workers.RemoveAll([](const UE::Tasks::FTask& Task) { return Task.IsCompleted(); });
+
+	while (!bShuttingDown && ActiveWorkers < MaxWorkers && ActiveWorkers < Pending.Num())
+	{
+		ActiveWorkers++;
+		Workers.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [this] { WorkerLoop(); }, UE::Tasks::ETaskPriority::BackgroundNormal));
+	}
+}
+
+void FSquirrelTileService::WorkerLoop()
+{
+	while (const TSharedPtr<FJob> Job = TakeNextJob())
+	{
+		Generate(*Job);
+
+		FScopeLock ScopeLock(&Lock);
+
+		Stats.Generated++;
+		Jobs.Remove(Job->Key);
+
+		if (Cache.Num() == Cache.Max())
+		{
+			CachedBytes -= Cache.RemoveLeastRecent()->GetAllocatedSize();
+			Stats.Evictions++;
+		}
+
+		Cache.Add(Job->Key, Job->Result);
+		CachedBytes += Job->Result->GetAllocatedSize();
+		EvictToBudget();
+
+		if (!Job->Requests.IsEmpty())
+		{
+			Completed.Add(Job.ToSharedRef());
+		}
+	}
+}
+
+TSharedPtr<FSquirrelTileService::FJob> FSquirrelTileService::TakeNextJob()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (bShuttingDown || Pending.IsEmpty())
+	{
+		ActiveWorkers--;
+		return nullptr;
+	}
+
+	// The focus may have moved since this job was requested, so find the nearest one now.
+	int32 Nearest = 0;
+	double NearestDistSq = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < Pending.Num(); ++i)
+	{
+		const double DistSq = FVector2D::DistSquared(Pending[i]->Center, Focus);
+		if (DistSq < NearestDistSq)
+		{
+			Nearest = i;
+			NearestDistSq = DistSq;
+		}
+	}
+
+	TSharedRef<FJob> Job = Pending[Nearest];
+	Pending.RemoveAtSwap(Nearest, 1, EAllowShrinking::No);
+	return Job;
+}
+
+void FSquirrelTileService::EvictToBudget()
+{
+	// Never evict the most recent tile, even if it alone is over budget.
+	while (CachedBytes > MaxCacheBytes && Cache.Num() > 1)
+	{
+		CachedBytes -= Cache.RemoveLeastRecent()->GetAllocatedSize();
+		Stats.Evictions++;
+	}
+}
+
+void FSquirrelTileService::CancelJob(const TSharedRef<FJob> Job)
+{
+	for (const TPair<uint64, FOnSquirrelTileReady>& Request : Job->Requests)
+	{
+		RequestKeys.Remove(Request.Key);
+	}
+
+	Stats.Cancellations++;
+	Pending.RemoveSwap(Job, EAllowShrinking::No);
+	Jobs.Remove(Job->Key);
+}
+
+void FSquirrelTileService::Generate(FJob& Job)
+{
+	const int32 Size = Job.TileSize;
+	SQUIRREL_TRACE_BATCH(GenerateTile, Size * Size);
+
+	const FVector Origin(FVector2D(Job.Key.Coord * Size) * Job.SampleSpacing, 0.0);
+
+	TArray<FVector> Points;
+	Points.SetNumUninitialized(Size * Size);
+	for (int32 Y = 0; Y < Size; ++Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			Points[X + Y * Size] = Origin + FVector(X, Y, 0.0) * Job.SampleSpacing;
+		}
+	}
+
+	TSharedRef<FSquirrelNoiseTile> Tile = MakeShared<FSquirrelNoiseTile>();
+	Tile->Key = Job.Key;
+	Tile->TileSize = Size;
+	Tile->Values.SetNumUninitialized(Points.Num());
+
+	if (Job.Program.IsValid())
+	{
+		Job.Program->EvaluateBatch(Job.Key.Seed, Points.GetData(), Points.Num(), Tile->Values.GetData());
+	}
+	else
+	{
+		Squirrel::Noise::Batch::Fractal2D(Job.Fractal, Job.Key.Seed, Points.GetData(), Points.Num(), Tile->Values.GetData());
+	}
+
+	Job.Result = Tile;
+}
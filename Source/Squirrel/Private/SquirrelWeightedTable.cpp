@@ -0,0 +1,233 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelWeightedTable.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The construction of the alias table and the way
+ *	samples are drawn from it determine the output of
+ *	existing seeds.
+ */
+
+namespace Squirrel::WeightedTable
+{
+	// Number of samples drawn from a single Fill call in batch sampling.
+	static constexpr int32 SampleChunkSize = 128;
+
+	static double SanitizeWeight(const double Weight)
+	{
+		// Also rejects NaN.
+		return Weight > 0.0 ? Weight : 0.0;
+	}
+
+	static int32 SampleColumn(const uint32 ColumnNoise, const uint32 CoinNoise, const TConstArrayView<uint32> Thresholds,
+		const TConstArrayView<int32> Aliases)
+	{
+		const int32 Column = static_cast<int32>((static_cast<uint64>(ColumnNoise) * static_cast<uint64>(Thresholds.Num())) >> 32);
+		return CoinNoise < Thresholds[Column] ? Column : Aliases[Column];
+	}
+}
+
+FSquirrelWeightedTable::FSquirrelWeightedTable(TArray<double> InWeights)
+{
+	SetWeights(MoveTemp(InWeights));
+}
+
+void FSquirrelWeightedTable::SetWeight(const int32 Index, const double Weight)
+{
+	Weights[Index] = Squirrel::WeightedTable::SanitizeWeight(Weight);
+	bBuilt = false;
+}
+
+void FSquirrelWeightedTable::SetWeights(TArray<double> InWeights)
+{
+	Weights = MoveTemp(InWeights);
+	for (double& Weight : Weights)
+	{
+		Weight = Squirrel::WeightedTable::SanitizeWeight(Weight);
+	}
+	bBuilt = false;
+}
+
+int32 FSquirrelWeightedTable::Add(const double Weight)
+{
+	bBuilt = false;
+	return Weights.Add(Squirrel::WeightedTable::SanitizeWeight(Weight));
+}
+
+void FSquirrelWeightedTable::Build()
+{
+	if (bBuilt)
+	{
+		return;
+	}
+
+	bBuilt = true;
+
+	const int32 Count = Weights.Num();
+	Thresholds.Reset(Count);
+	Aliases.Reset(Count);
+
+	double Total = 0.0;
+	for (const double Weight : Weights)
+	{
+		// Weights that were edited directly in a details panel bypass SetWeight.
+		Total += Squirrel::WeightedTable::SanitizeWeight(Weight);
+	}
+
+	if (Total <= 0.0)
+	{
+		// Leave the table empty, which Sample reports as INDEX_NONE.
+		return;
+	}
+
+	Thresholds.SetNumUninitialized(Count);
+	Aliases.SetNumUninitialized(Count);
+
+	// Scale the weights so that they average 1, then pair every column below 1 with one above it that makes up the difference.
+	TArray<double> Scaled;
+	Scaled.SetNumUninitialized(Count);
+
+	TArray<int32> Small;
+	TArray<int32> Large;
+	Small.Reserve(Count);
+	Large.Reserve(Count);
+
+	const double Scale = static_cast<double>(Count) / Total;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Scaled[i] = Squirrel::WeightedTable::SanitizeWeight(Weights[i]) * Scale;
+		(Scaled[i] < 1.0 ? Small : Large).Add(i);
+	}
+
+	while (!Small.IsEmpty() && !Large.IsEmpty())
+	{
+		const int32 Less = Small.Pop(EAllowShrinking::No);
+		const int32 More = Large.Pop(EAllowShrinking::No);
+
+		// Scaled[Less] is in [0, 1), so this cannot reach 2^32.
+		Thresholds[Less] = static_cast<uint32>(Scaled[Less] * 4294967296.0);
+		Aliases[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.0;
+		(Scaled[More] < 1.0 ? Small : Large).Add(More);
+	}
+
+	// Whatever remains is full, up to rounding error. Aliasing a column to itself makes the threshold irrelevant.
+	for (const int32 Index : Small)
+	{
+		Thresholds[Index] = MAX_uint32;
+		Aliases[Index] = Index;
+	}
+	for (const int32 Index : Large)
+	{
+		Thresholds[Index] = MAX_uint32;
+		Aliases[Index] = Index;
+	}
+}
+
+int32 FSquirrelWeightedTable::Sample(FSquirrelState& State)
+{
+	Build();
+	return static_cast<const FSquirrelWeightedTable*>(this)->Sample(State);
+}
+
+int32 FSquirrelWeightedTable::Sample(FSquirrelState& State) const
+{
+	checkf(bBuilt, TEXT("FSquirrelWeightedTable must be built before it can be sampled through a const reference"));
+	SQUIRREL_COUNT(WeightedSamples, 1);
+
+	const uint32 ColumnNoise = Squirrel::Next<uint32>(State);
+	const uint32 CoinNoise = Squirrel::Next<uint32>(State);
+
+	if (Thresholds.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	return Squirrel::WeightedTable::SampleColumn(ColumnNoise, CoinNoise, Thresholds, Aliases);
+}
+
+void FSquirrelWeightedTable::Sample(FSquirrelState& State, const TArrayView<int32> Out)
+{
+	Build();
+	static_cast<const FSquirrelWeightedTable*>(this)->Sample(State, Out);
+}
+
+void FSquirrelWeightedTable::Sample(FSquirrelState& State, const TArrayView<int32> Out) const
+{
+	checkf(bBuilt, TEXT("FSquirrelWeightedTable must be built before it can be sampled through a const reference"));
+	SQUIRREL_TRACE_BATCH(SampleWeightedTable, Out.Num());
+	SQUIRREL_COUNT(WeightedSamples, Out.Num());
+
+	uint32 Noise[Squirrel::WeightedTable::SampleChunkSize * PositionsPerSample];
+
+	for (int32 Offset = 0; Offset < Out.Num(); Offset += Squirrel::WeightedTable::SampleChunkSize)
+	{
+		const int32 Count = FMath::Min(Squirrel::WeightedTable::SampleChunkSize, Out.Num() - Offset);
+		Squirrel::Fill(State, MakeArrayView(Noise, Count * PositionsPerSample));
+
+		int32* Dest = Out.GetData() + Offset;
+		if (Thresholds.IsEmpty())
+		{
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Dest[i] = INDEX_NONE;
+			}
+			continue;
+		}
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			Dest[i] = Squirrel::WeightedTable::SampleColumn(Noise[i * 2], Noise[i * 2 + 1], Thresholds, Aliases);
+		}
+	}
+}
+
+FSquirrelWeightedTable USquirrelWeightedTableLibrary::MakeWeightedTable(const TArray<double>& Weights)
+{
+	return FSquirrelWeightedTable(Weights);
+}
+
+void USquirrelWeightedTableLibrary::SetWeight(FSquirrelWeightedTable& Table, const int32 Index, const double Weight)
+{
+	if (Table.GetWeights().IsValidIndex(Index))
+	{
+		Table.SetWeight(Index, Weight);
+	}
+}
+
+int32 USquirrelWeightedTableLibrary::GetNumWeights(const FSquirrelWeightedTable& Table)
+{
+	return Table.Num();
+}
+
+int32 USquirrelWeightedTableLibrary::NextWeightedIndex(USquirrel* Squirrel, FSquirrelWeightedTable& Table)
+{
+	if (!IsValid(Squirrel))
+	{
+		return INDEX_NONE;
+	}
+
+	FSquirrelContextScope Scope(Squirrel->GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*Squirrel);
+	return Table.Sample(Squirrel->GetState());
+}
+
+void USquirrelWeightedTableLibrary::NextWeightedIndices(USquirrel* Squirrel, FSquirrelWeightedTable& Table, const int32 Count,
+	TArray<int32>& OutIndices)
+{
+	OutIndices.Reset();
+
+	if (!IsValid(Squirrel) || Count <= 0)
+	{
+		return;
+	}
+
+	OutIndices.SetNumUninitialized(Count);
+
+	FSquirrelContextScope Scope(Squirrel->GetContext());
+	SQUIRREL_TRACK_OBJECT_DRAWS(*Squirrel);
+	Table.Sample(Squirrel->GetState(), OutIndices);
+}
\ No newline at end of file
@@ -3,6 +3,10 @@
 #pragma once
 
 #include "UObject/Object.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SquirrelStats.h"
+#include "SquirrelNoise5.hpp"
+#include <atomic>
 
 #include "Squirrel.generated.h"
 
@@ -19,6 +23,11 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogSquirrel, Log, All)
 
+class FSquirrelContext;
+class FSquirrelTileService;
+struct FNetDeltaSerializeInfo;
+class USquirrelWorldSubsystem;
+
 USTRUCT(BlueprintType)
 struct SQUIRREL_API FSquirrelState
 {
@@ -31,6 +40,55 @@ struct SQUIRREL_API FSquirrelState
 #if WITH_EDITOR
 	void RandomizeState();
 #endif
+
+	// Writes the position as-is, in 32 bits. Used when the state is nested in another replicated struct, or sent in an RPC.
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	/**
+	 * Used when the state is a replicated property of its own. The first send writes the position as-is. After that, only
+	 * the difference from the position last sent to that connection is written, as a variable-length integer, so a stream
+	 * that has advanced by fewer than 64 draws costs 18 bits, and an unchanged one nothing.
+	 */
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	friend bool operator==(const FSquirrelState& A, const FSquirrelState& B) { return A.Position == B.Position; }
+};
+
+template <>
+struct TStructOpsTypeTraits<FSquirrelState> : TStructOpsTypeTraitsBase2<FSquirrelState>
+{
+	enum
+	{
+		WithIdenticalViaEquality = true,
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+		WithNetDeltaSerializer = true
+	};
+};
+
+/**
+ * An opt-in stream with a 64-bit position, for streams that would otherwise wrap after 2^32 draws. Every draw is a single
+ * SquirrelNoise64 hash with 64 bits of output. It does not generate the same values as a FSquirrelState.
+ */
+USTRUCT(BlueprintType)
+struct SQUIRREL_API FSquirrelState64
+{
+	GENERATED_BODY()
+
+	/** Location in the noise. Use this to "scrub" generation forward and backward. */
+	UPROPERTY(BlueprintReadOnly, EditInstanceOnly, Category = "SquirrelState")
+	int64 Position = 0;
+
+	friend bool operator==(const FSquirrelState64& A, const FSquirrelState64& B) { return A.Position == B.Position; }
+};
+
+template <>
+struct TStructOpsTypeTraits<FSquirrelState64> : TStructOpsTypeTraitsBase2<FSquirrelState64>
+{
+	enum
+	{
+		WithIdenticalViaEquality = true
+	};
 };
 
 namespace Squirrel
@@ -38,15 +96,34 @@ namespace Squirrel
 	namespace Impl
 	{
 		// Direct access to calling SquirrelNoise5
-		[[nodiscard]] constexpr uint32 SquirrelNoise5(int32& Position, uint32 Seed);
+		[[nodiscard]] constexpr uint32 SquirrelNoise5(int32& Position, const uint32 Seed)
+		{
+			return Raw::SquirrelNoise5(Position++, Seed);
+		}
+
+		// Direct access to calling SquirrelNoise64
+		[[nodiscard]] constexpr uint64 SquirrelNoise64(int64& Position, const uint64 Seed)
+		{
+			return Raw::SquirrelNoise64(Position++, Seed);
+		}
 	}
 
 	// Use SquirrelNoise to mangle two values together.
 	SQUIRREL_API [[nodiscard]] uint32 HashCombine(int32 A, int32 B);
 
-	uint32 GetGlobalSeed();
+	// The seed of the calling thread's current context. Unless a FSquirrelContextScope is open on this thread, this is the
+	// seed of the default, process-wide context. Safe to call from any thread.
+	SQUIRREL_API uint32 GetGlobalSeed();
+
+	// Set the seed of the calling thread's current context. Safe to call from any thread, but changing the seed while other
+	// threads are generating will make them nondeterministic.
+	SQUIRREL_API void SetGlobalSeed(uint32 Seed);
+
+	// The context used whenever no other is bound. Everything that predates contexts generates from this one.
+	SQUIRREL_API FSquirrelContext& GetDefaultContext();
 
-	void SetGlobalSeed(uint32 Seed);
+	// The context bound to the calling thread by the innermost FSquirrelContextScope, or the default context.
+	SQUIRREL_API FSquirrelContext& GetCurrentContext();
 
 	template <
 		typename T
@@ -54,6 +131,7 @@ namespace Squirrel
 	>
 	[[nodiscard]] constexpr T Next(FSquirrelState& State)
 	{
+		SQUIRREL_COUNT(Next, 1);
 		if constexpr (sizeof(T) >= 4)
 		{
 			return static_cast<T>(Impl::SquirrelNoise5(State.Position, GetGlobalSeed()));
@@ -67,16 +145,20 @@ namespace Squirrel
 	template <>
 	[[nodiscard]] constexpr bool Next(FSquirrelState& State)
 	{
+		SQUIRREL_COUNT(Next, 1);
 		return !!(Impl::SquirrelNoise5(State.Position, GetGlobalSeed()) % 2);
 	}
 
-	SQUIRREL_API constexpr int32 NextInt32(FSquirrelState& State, const int32 Max);
+	// The functions below read the seed of the current context on every call. For hot loops, TSquirrelRng (SquirrelRng.h)
+	// generates the same values inline, from a seed read once.
 
-	SQUIRREL_API constexpr int32 NextInt32InRange(FSquirrelState& State, const int32 Min, const int32 Max);
+	SQUIRREL_API int32 NextInt32(FSquirrelState& State, const int32 Max);
 
-	SQUIRREL_API constexpr double NextReal(FSquirrelState& State);
+	SQUIRREL_API int32 NextInt32InRange(FSquirrelState& State, const int32 Min, const int32 Max);
 
-	SQUIRREL_API constexpr double NextRealInRange(FSquirrelState& State, const double Min, const double Max);
+	SQUIRREL_API double NextReal(FSquirrelState& State);
+
+	SQUIRREL_API double NextRealInRange(FSquirrelState& State, const double Min, const double Max);
 
 	/**
 	 * Roll for a deterministic chance of an event occurring.
@@ -86,14 +168,201 @@ namespace Squirrel
 	 * @param Chance The percentage chance for the event to occur. Roll must meet or exceed this to succeed.
 	 * @param RollModifier A modifier to adjust the likelihood of the occurence. Must be a value between -100 and 100
 	 * @return True if the event should occur
+	 * @see V2::Roll, for rolling many times against the same chance.
 	 */
-	SQUIRREL_API [[nodiscard]] constexpr bool RollChance(FSquirrelState& State, double& Roll, const double Chance, const double RollModifier);
+	SQUIRREL_API [[nodiscard]] bool RollChance(FSquirrelState& State, double& Roll, const double Chance, const double RollModifier);
 
 	/**
 	 * Round a float to an int with a chanced result, where the result is determined by the decimal.
 	 * Example: Value = 3.25 has a 25% chance to return 4 and a 75% chance to return 3.
 	 */
-	SQUIRREL_API [[nodiscard]] constexpr int32 RoundWithWeightByFraction(FSquirrelState& State, double Value);
+	SQUIRREL_API [[nodiscard]] int32 RoundWithWeightByFraction(FSquirrelState& State, double Value);
+
+	/**
+	 * Fill an array with the raw output of consecutive positions, advancing State by the number of elements.
+	 * Output is identical to calling Next<uint32> once per element, but is generated in SIMD lanes where supported.
+	 */
+	SQUIRREL_API void Fill(FSquirrelState& State, TArrayView<uint32> Out);
+
+	/**
+	 * Fill an array with values in the range [0,1], advancing State by the number of elements.
+	 * Output is identical to calling NextReal once per element.
+	 */
+	SQUIRREL_API void Fill(FSquirrelState& State, TArrayView<double> Out);
+
+	/**
+	 * Fill an array with values in the range [0,1], advancing State by the number of elements.
+	 * Output is identical to casting the result of NextReal to float once per element.
+	 */
+	SQUIRREL_API void Fill(FSquirrelState& State, TArrayView<float> Out);
+
+	/**
+	 * Advance many independent streams by one position each, where stream i is at Positions[i] under Seeds[i].
+	 * Out[i] is identical to the raw output of that stream's next position, but is generated in SIMD lanes where supported.
+	 */
+	SQUIRREL_API void NextEach(TArrayView<int32> Positions, TConstArrayView<uint32> Seeds, TArrayView<uint32> Out);
+
+	/**
+	 * Derive the state of an independent child stream from a parent, without advancing the parent. Children only depend on
+	 * the parent's position, the current seed, and their index, so they can be derived in any order, on any thread.
+	 */
+	SQUIRREL_API [[nodiscard]] FSquirrelState Split(const FSquirrelState& Parent, int32 Index);
+
+	// Derive the states of Children.Num() child streams. Identical to calling Split with each index in turn.
+	SQUIRREL_API void Split(const FSquirrelState& Parent, TArrayView<FSquirrelState> Children);
+
+	// Derive an independent child seed, for the functions that take an explicit seed (noise, grids, scattering).
+	SQUIRREL_API [[nodiscard]] uint32 SplitSeed(uint32 Seed, int32 Index);
+
+	/**
+	 * Versioned generation. A version never changes what it generates for a given seed and position, so improvements are
+	 * added as a new version alongside the old ones, and call sites opt in by naming the version they want.
+	 * V2 replaces the floating-point range reduction of the legacy integer functions with integer multiply-shift.
+	 */
+	namespace V2
+	{
+		enum class EBoundedMode : uint8
+		{
+			// A single multiply-shift per value, which always consumes exactly one position per 32 bits of output. Values are
+			// biased by at most Range / 2^32 (or Range / 2^64 for 64-bit), which is negligible for small ranges.
+			Fast,
+
+			// Rejects the few raw values that would bias the result, so every value in range is exactly equally likely. This
+			// almost always consumes the same positions as Fast, and occasionally consumes more.
+			Unbiased
+		};
+
+		// A value in [0, Max). Returns 0 if Max is not positive.
+		SQUIRREL_API [[nodiscard]] int32 NextInt32(FSquirrelState& State, int32 Max, EBoundedMode Mode = EBoundedMode::Unbiased);
+
+		// A value in [Min, Max], for any Min and Max in the int32 range. Returns Min if Max is less than Min.
+		SQUIRREL_API [[nodiscard]] int32 NextInt32InRange(FSquirrelState& State, int32 Min, int32 Max, EBoundedMode Mode = EBoundedMode::Unbiased);
+
+		// A value in [Min, Max], for any Min and Max in the int64 range. Each draw consumes two positions. Returns Min if Max
+		// is less than Min.
+		SQUIRREL_API [[nodiscard]] int64 NextInt64InRange(FSquirrelState& State, int64 Min, int64 Max, EBoundedMode Mode = EBoundedMode::Unbiased);
+
+		/**
+		 * Fill an array with values in [Min, Max], advancing State by the number of positions consumed.
+		 * Output is identical to calling NextInt32InRange once per element, but the raw noise is generated in SIMD lanes where supported.
+		 */
+		SQUIRREL_API void FillInt32InRange(FSquirrelState& State, int32 Min, int32 Max, TArrayView<int32> Out, EBoundedMode Mode = EBoundedMode::Unbiased);
+
+		/**
+		 * Fill an array with values in [Min, Max], advancing State by the number of positions consumed.
+		 * Output is identical to calling NextInt64InRange once per element.
+		 */
+		SQUIRREL_API void FillInt64InRange(FSquirrelState& State, int64 Min, int64 Max, TArrayView<int64> Out, EBoundedMode Mode = EBoundedMode::Unbiased);
+
+		/**
+		 * A probability, converted once into a threshold on the raw noise, so that each roll is one hash and one compare.
+		 * A roll succeeds when the noise is below Threshold, which is out of 2^32 so that both 0 and 1 are exact.
+		 */
+		struct FChance
+		{
+			uint64 Threshold = 0;
+
+			// The chance of a roll succeeding, from 0 to 1. Values outside of that range are clamped.
+			static constexpr FChance FromProbability(const double Probability)
+			{
+				FChance Chance;
+				if (Probability >= 1.0)
+				{
+					Chance.Threshold = 1ull << 32;
+				}
+				else if (Probability > 0.0)
+				{
+					Chance.Threshold = static_cast<uint64>(Probability * 4294967296.0);
+				}
+				return Chance;
+			}
+
+			// The same probability of success as the legacy RollChance with these arguments. The rolls themselves differ.
+			static constexpr FChance FromRollChance(const double Chance, const double RollModifier)
+			{
+				return RollModifier >= 100.0 ? FromProbability(Chance <= 100.0 ? 1.0 : 0.0) : FromProbability((100.0 - Chance) / (100.0 - RollModifier));
+			}
+
+			constexpr bool Test(const uint32 Noise) const { return Noise < Threshold; }
+		};
+
+		// Roll once, consuming one position.
+		SQUIRREL_API [[nodiscard]] bool Roll(FSquirrelState& State, FChance Chance);
+
+		/**
+		 * Roll Num times, consuming Num positions, and set bit (i % 32) of OutMask[i / 32] for each roll i that succeeded.
+		 * OutMask must have at least DivideAndRoundUp(Num, 32) elements. Unused bits of the last element are cleared.
+		 */
+		SQUIRREL_API void FillRolls(FSquirrelState& State, FChance Chance, int32 Num, TArrayView<uint32> OutMask);
+
+		// Roll once against each of Chances, in the same layout as above.
+		SQUIRREL_API void FillRolls(FSquirrelState& State, TConstArrayView<FChance> Chances, TArrayView<uint32> OutMask);
+
+		/**
+		 * Round down or up to an integer, with a chance of rounding up equal to the fraction of the value. For example, 3.25
+		 * has a 25% chance to round to 4 and a 75% chance to round to 3. Unlike RoundWithWeightByFraction, this always
+		 * consumes exactly one position, and compares the raw noise against the fraction instead of a NextReal.
+		 */
+		SQUIRREL_API [[nodiscard]] double RoundStochastic(FSquirrelState& State, double Value);
+
+		// Round every value in place. Identical to calling RoundStochastic once per element.
+		SQUIRREL_API void RoundStochastic(FSquirrelState& State, TArrayView<double> Values);
+
+		// Round every value in place. Identical to calling RoundStochastic once per element.
+		SQUIRREL_API void RoundStochastic(FSquirrelState& State, TArrayView<float> Values);
+	}
+
+	/*
+	 * 64-bit streams. Each draw consumes exactly one position and hashes it to 64 bits with SquirrelNoise64, under the seed
+	 * of the current context.
+	 */
+
+	// A value in the full range of T, or a bool. Values of less than 32 bits are reduced the same way as Next(FSquirrelState&).
+	template <
+		typename T
+		UE_REQUIRES(TIsIntegral<T>::Value)
+	>
+	[[nodiscard]] constexpr T Next(FSquirrelState64& State)
+	{
+		SQUIRREL_COUNT(Next, 1);
+		const uint64 Noise = Impl::SquirrelNoise64(State.Position, GetGlobalSeed());
+
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			return !!(Noise % 2);
+		}
+		else if constexpr (sizeof(T) >= 4)
+		{
+			return static_cast<T>(Noise);
+		}
+		else
+		{
+			return static_cast<T>(Noise % TNumericLimits<T>::Max());
+		}
+	}
+
+	// A multiple of 2^-53 in the range [0,1), from a single draw.
+	SQUIRREL_API [[nodiscard]] double NextReal(FSquirrelState64& State);
+
+	// A value in the range [Min,Max), from a single draw.
+	SQUIRREL_API [[nodiscard]] double NextRealInRange(FSquirrelState64& State, double Min, double Max);
+
+	// A value in [Min, Max], for any Min and Max in the int32 range, reduced with V2's multiply-shift. Returns Min if Max
+	// is less than Min.
+	SQUIRREL_API [[nodiscard]] int32 NextInt32InRange(FSquirrelState64& State, int32 Min, int32 Max, V2::EBoundedMode Mode = V2::EBoundedMode::Unbiased);
+
+	// A value in [Min, Max], for any Min and Max in the int64 range, from a single draw unless rejected. Returns Min if Max
+	// is less than Min.
+	SQUIRREL_API [[nodiscard]] int64 NextInt64InRange(FSquirrelState64& State, int64 Min, int64 Max, V2::EBoundedMode Mode = V2::EBoundedMode::Unbiased);
+
+	// Fill an array with the raw output of consecutive positions. Identical to calling Next<uint64> once per element.
+	SQUIRREL_API void Fill(FSquirrelState64& State, TArrayView<uint64> Out);
+
+	// Fill an array with values in the range [0,1). Identical to calling NextReal once per element.
+	SQUIRREL_API void Fill(FSquirrelState64& State, TArrayView<double> Out);
+
+	// Fill an array with values in [Min, Max]. Identical to calling NextInt64InRange once per element.
+	SQUIRREL_API void FillInt64InRange(FSquirrelState64& State, int64 Min, int64 Max, TArrayView<int64> Out, V2::EBoundedMode Mode = V2::EBoundedMode::Unbiased);
 }
 
 /**
@@ -111,6 +380,13 @@ public:
 
 	FSquirrelState& GetState() { return State; }
 
+	// The context this Squirrel generates from: its world's isolated context if it has one, otherwise the caller's current
+	// context. C++ code generating from GetState() directly should open a FSquirrelContextScope on this.
+	FSquirrelContext& GetContext() const;
+
+	// The number of positions consumed through this Squirrel's functions while Squirrel.Stats.PerObject was enabled.
+	uint64 GetDrawTotal() const { return DrawTotal; }
+
 	UFUNCTION(BlueprintCallable, Category = "Squirrel")
 	void Jump(const int32 NewPosition);
 
@@ -150,9 +426,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Squirrel")
 	int32 RoundWithWeightByFraction(double Value);
 
+	/**
+	 * Pick K unique indices in [0, N), in random order. Consumes exactly Min(K, N) positions.
+	 * Pass K = N for a shuffled order of N indices, to shuffle an array of any type.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	void SampleWithoutReplacement(int32 N, int32 K, TArray<int32>& OutIndices);
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Squirrel")
 	FSquirrelState State;
+
+private:
+	// The world this Squirrel was created in. Resolved on each call, so that a world can isolate its context after its
+	// Squirrels were loaded.
+	TWeakObjectPtr<const USquirrelWorldSubsystem> WorldSubsystem;
+
+	uint64 DrawTotal = 0;
+
+	friend Squirrel::Stats::FObjectDrawScope;
 };
 
 
@@ -160,7 +452,7 @@ protected:
  * Combines the global seed and subsystem state into an easily serialized struct.
  */
 USTRUCT(BlueprintType)
-struct FSquirrelWorldState
+struct SQUIRREL_API FSquirrelWorldState
 {
 	GENERATED_BODY()
 
@@ -171,6 +463,77 @@ struct FSquirrelWorldState
 	// The position of the Squirrel Subsystem.
 	UPROPERTY()
 	FSquirrelState RuntimeState;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	// Like FSquirrelState::NetDeltaSerialize. The seed is only written when it has changed.
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	friend bool operator==(const FSquirrelWorldState& A, const FSquirrelWorldState& B)
+	{
+		return A.GlobalSeed == B.GlobalSeed && A.RuntimeState == B.RuntimeState;
+	}
+};
+
+template <>
+struct TStructOpsTypeTraits<FSquirrelWorldState> : TStructOpsTypeTraitsBase2<FSquirrelWorldState>
+{
+	enum
+	{
+		WithIdenticalViaEquality = true,
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+		WithNetDeltaSerializer = true
+	};
+};
+
+
+/**
+ * A seed and a stream of runtime positions. Generation reads its seed from the calling thread's current context, so
+ * several contexts can generate in parallel without sharing any mutable state, e.g. one per match on a server hosting many.
+ * The members are atomic, so a single context may also be shared between threads.
+ */
+class SQUIRREL_API FSquirrelContext
+{
+public:
+	explicit FSquirrelContext(uint32 InSeed = 0, int32 InRuntimePosition = 0);
+
+	UE_NONCOPYABLE(FSquirrelContext)
+
+	uint32 GetSeed() const { return Seed.load(std::memory_order_relaxed); }
+	void SetSeed(const uint32 NewSeed) { Seed.store(NewSeed, std::memory_order_relaxed); }
+
+	// Get a new position for a Squirrel that is created during gameplay. Safe to call from any thread.
+	int32 NewPosition();
+
+	FSquirrelWorldState SaveState() const;
+	void LoadState(const FSquirrelWorldState& State);
+
+private:
+	std::atomic<uint32> Seed;
+
+	// The position of the stream that new runtime positions are drawn from. Advanced atomically, so that Squirrels created
+	// on async loading or worker threads can request positions without locking. Single-threaded, this hands out exactly
+	// the same sequence that Squirrel::Next<int32> on an FSquirrelState would.
+	std::atomic<int32> RuntimePosition;
+};
+
+/**
+ * Binds a context to the calling thread for the lifetime of the scope. Scopes nest, and binding null keeps the current
+ * context. Bindings are not inherited by tasks launched from inside the scope; open another scope in the task body, and
+ * keep the context alive for as long as the task may run.
+ */
+class SQUIRREL_API FSquirrelContextScope
+{
+public:
+	explicit FSquirrelContextScope(FSquirrelContext* Context);
+	explicit FSquirrelContextScope(FSquirrelContext& Context) : FSquirrelContextScope(&Context) {}
+	~FSquirrelContextScope();
+
+	UE_NONCOPYABLE(FSquirrelContextScope)
+
+private:
+	FSquirrelContext* Previous;
 };
 
 
@@ -189,10 +552,11 @@ public:
 	virtual void Deinitialize() override;
 
 protected:
-	// Get a new position for a Squirrel that is created during gameplay.
+	// Get a new position for a Squirrel that is created during gameplay from the default context. Safe to call from any thread.
 	int32 NewPosition();
 
 public:
+	// These always operate on the default context. Use USquirrelWorldSubsystem for worlds with their own.
 	UFUNCTION(BlueprintCallable, Category = "Squirrel")
 	int64 GetGlobalSeed() const;
 
@@ -205,7 +569,49 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Squirrel")
 	void LoadGameState(FSquirrelWorldState State);
 
+	// Asynchronous, cached generation of noise tiles.
+	FSquirrelTileService& GetTileService() const { return *TileService; }
+
+private:
+	TSharedPtr<FSquirrelTileService> TileService;
+};
+
+
+/*
+ * Scopes seeded generation to a single world. By default a world shares the default context with the rest of the process.
+ * Once IsolateContext is called, Squirrels in this world generate from, and draw runtime positions from, a context of its own.
+ */
+UCLASS()
+class SQUIRREL_API USquirrelWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Give this world its own seed and runtime-position stream, independent of every other world.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	void IsolateContext(int64 Seed);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	bool HasIsolatedContext() const { return IsolatedContext.IsValid(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	int64 GetSeed() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	void SetSeed(int64 NewSeed);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	FSquirrelWorldState SaveWorldState() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	void LoadWorldState(FSquirrelWorldState State);
+
+	// This world's isolated context, or the default context.
+	FSquirrelContext& GetContext() const;
+
+	// This world's isolated context, if it has one. Hold on to this to keep the context alive in tasks that outlive the world.
+	TSharedPtr<FSquirrelContext, ESPMode::ThreadSafe> GetIsolatedContext() const { return IsolatedContext; }
+
 private:
-	UPROPERTY(Transient)
-	FSquirrelState RuntimePositionsSquirrel;
+	TSharedPtr<FSquirrelContext, ESPMode::ThreadSafe> IsolatedContext;
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Benchmarks and golden-output checks for every Squirrel API.
+ *
+ * Run with the Squirrel.Benchmark console command, or headless with the SquirrelBenchmark commandlet. Every optimized path
+ * is checked to be bit-exact with its scalar reference, and the reference paths are checked against checksums of their
+ * output for a fixed seed, so that a change that breaks existing seeds fails loudly.
+ */
+namespace Squirrel::Benchmark
+{
+	struct FOptions
+	{
+		// Number of values generated by each benchmark.
+		int32 Iterations = 1 << 20;
+
+		// Highest number of threads to measure scaling with. 0 measures up to the number of worker threads.
+		int32 MaxThreads = 0;
+
+		// Only run the checks, skipping the timings.
+		bool bVerifyOnly = false;
+	};
+
+	// Log the results to LogSquirrel. Returns false if any check failed.
+	SQUIRREL_API bool Run(const FOptions& Options);
+}
\ No newline at end of file
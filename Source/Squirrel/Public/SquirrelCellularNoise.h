@@ -0,0 +1,82 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+#include "SquirrelCellularNoise.generated.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The placement of feature points determines the
+ *	output of existing seeds.
+ */
+
+/**
+ * Settings for Worley (cellular) noise.
+ */
+USTRUCT(BlueprintType)
+struct SQUIRREL_API FSquirrelCellularSettings
+{
+	GENERATED_BODY()
+
+	// Number of cells per unit.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cellular")
+	double Frequency = 1.0;
+
+	// How far feature points may stray from the center of their cell. 0 produces a regular grid.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cellular", meta = (ClampMin = 0, ClampMax = 1))
+	double Jitter = 1.0;
+
+	// Only find the nearest feature. Skips neighbouring cells that cannot contain a nearer feature, and leaves F2 unset.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cellular")
+	bool bF1Only = false;
+
+	friend uint32 GetTypeHash(const FSquirrelCellularSettings& Settings)
+	{
+		uint32 Hash = GetTypeHash(Settings.Frequency);
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.Jitter));
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.bF1Only));
+		return Hash;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct SQUIRREL_API FSquirrelCellularResult
+{
+	GENERATED_BODY()
+
+	// Distance to the nearest feature point, in cells.
+	UPROPERTY(BlueprintReadOnly, Category = "Cellular")
+	double F1 = TNumericLimits<double>::Max();
+
+	// Distance to the second-nearest feature point, in cells. Not computed in F1-only mode.
+	UPROPERTY(BlueprintReadOnly, Category = "Cellular")
+	double F2 = TNumericLimits<double>::Max();
+
+	// Hash of the cell owning the nearest feature point. Stable for a given seed, so it can be used to color regions.
+	UPROPERTY(BlueprintReadOnly, Category = "Cellular")
+	int64 CellId = 0;
+};
+
+/*
+ * Seeded Worley noise. Each cell owns a single feature point, placed by the bits of Get2dNoiseUint/Get3dNoiseUint for that
+ * cell. The hashes for all neighbouring cells of a sample (9 in 2D, 27 in 3D) are generated together in SIMD lanes.
+ */
+namespace Squirrel::Cellular
+{
+	SQUIRREL_API [[nodiscard]] FSquirrelCellularResult Cellular2D(const FSquirrelCellularSettings& Settings, const FVector2D& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] FSquirrelCellularResult Cellular3D(const FSquirrelCellularSettings& Settings, const FVector& Point, uint32 Seed);
+
+	SQUIRREL_API void SampleCellular2D(const FSquirrelCellularSettings& Settings, uint32 Seed, TConstArrayView<FVector2D> Points, TArrayView<FSquirrelCellularResult> Out);
+	SQUIRREL_API void SampleCellular3D(const FSquirrelCellularSettings& Settings, uint32 Seed, TConstArrayView<FVector> Points, TArrayView<FSquirrelCellularResult> Out);
+
+	// Sample a grid of Size points, where point (X, Y) is at (Origin + (X, Y) * Spacing). Output is X-major.
+	SQUIRREL_API void SampleCellularGrid2D(const FSquirrelCellularSettings& Settings, uint32 Seed,
+		const FVector2D& Origin, const FVector2D& Spacing, FIntPoint Size, TArrayView<FSquirrelCellularResult> Out);
+
+	// Sample a grid of Size points, where point (X, Y, Z) is at (Origin + (X, Y, Z) * Spacing). Output is X-major.
+	SQUIRREL_API void SampleCellularGrid3D(const FSquirrelCellularSettings& Settings, uint32 Seed,
+		const FVector& Origin, const FVector& Spacing, FIntVector Size, TArrayView<FSquirrelCellularResult> Out);
+}
@@ -0,0 +1,125 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+#include "SquirrelCoherentNoise.generated.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The lattice hashing, gradient tables, and octave
+ *	seeding here determine the output of existing seeds.
+ */
+
+UENUM(BlueprintType)
+enum class ESquirrelNoiseBasis : uint8
+{
+	// Smoothly interpolated random values at each lattice point.
+	Value,
+
+	// Perlin-style noise, with a random gradient at each lattice point.
+	Gradient
+};
+
+UENUM(BlueprintType)
+enum class ESquirrelFractalType : uint8
+{
+	// Fractal Brownian motion. Sum of octaves, in the range [-1,1].
+	FBm,
+
+	// Sum of inverted, squared octaves, producing sharp ridges. In the range [0,1].
+	Ridged,
+
+	// Sum of absolute octaves, producing billowy creases. In the range [0,1].
+	Turbulence
+};
+
+/**
+ * Settings for combining several octaves of coherent noise.
+ */
+USTRUCT(BlueprintType)
+struct SQUIRREL_API FSquirrelFractalSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fractal")
+	ESquirrelNoiseBasis Basis = ESquirrelNoiseBasis::Gradient;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fractal")
+	ESquirrelFractalType Type = ESquirrelFractalType::FBm;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fractal", meta = (ClampMin = 1, ClampMax = 16))
+	int32 Octaves = 4;
+
+	// Frequency of the first octave.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fractal")
+	double Frequency = 1.0;
+
+	// Frequency multiplier applied to each successive octave.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fractal")
+	double Lacunarity = 2.0;
+
+	// Amplitude multiplier applied to each successive octave.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fractal")
+	double Gain = 0.5;
+
+	bool operator==(const FSquirrelFractalSettings& Other) const
+	{
+		return Basis == Other.Basis && Type == Other.Type && Octaves == Other.Octaves && Frequency == Other.Frequency &&
+			Lacunarity == Other.Lacunarity && Gain == Other.Gain;
+	}
+
+	friend uint32 GetTypeHash(const FSquirrelFractalSettings& Settings)
+	{
+		uint32 Hash = GetTypeHash(Settings.Basis);
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.Type));
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.Octaves));
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.Frequency));
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.Lacunarity));
+		Hash = HashCombineFast(Hash, GetTypeHash(Settings.Gain));
+		return Hash;
+	}
+};
+
+/*
+ * Seeded coherent noise, built on the SquirrelNoise5 lattice hashes (Get1d-Get4dNoiseUint).
+ *
+ * The single noise functions return values in approximately [-1,1]. Pass Squirrel::GetGlobalSeed() as the seed to follow
+ * the world seed. Each octave of a fractal is seeded with Get1dNoiseUint(Octave, Seed).
+ *
+ * The Sample functions evaluate fractals for many points at once: the lattice hashes of a batch of points are generated
+ * together in SIMD lanes, and batches are spread across worker threads. Output is written in the same order as the input
+ * points, or X-major for grids.
+ */
+namespace Squirrel::Noise
+{
+	SQUIRREL_API [[nodiscard]] double Value1D(double X, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Value2D(const FVector2D& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Value3D(const FVector& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Value4D(const FVector4& Point, uint32 Seed);
+
+	SQUIRREL_API [[nodiscard]] double Gradient1D(double X, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Gradient2D(const FVector2D& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Gradient3D(const FVector& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Gradient4D(const FVector4& Point, uint32 Seed);
+
+	SQUIRREL_API [[nodiscard]] double Fractal1D(const FSquirrelFractalSettings& Settings, double X, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Fractal2D(const FSquirrelFractalSettings& Settings, const FVector2D& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Fractal3D(const FSquirrelFractalSettings& Settings, const FVector& Point, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] double Fractal4D(const FSquirrelFractalSettings& Settings, const FVector4& Point, uint32 Seed);
+
+	SQUIRREL_API void SampleFractal1D(const FSquirrelFractalSettings& Settings, uint32 Seed, TConstArrayView<double> Points, TArrayView<double> Out);
+	SQUIRREL_API void SampleFractal2D(const FSquirrelFractalSettings& Settings, uint32 Seed, TConstArrayView<FVector2D> Points, TArrayView<double> Out);
+	SQUIRREL_API void SampleFractal3D(const FSquirrelFractalSettings& Settings, uint32 Seed, TConstArrayView<FVector> Points, TArrayView<double> Out);
+	SQUIRREL_API void SampleFractal4D(const FSquirrelFractalSettings& Settings, uint32 Seed, TConstArrayView<FVector4> Points, TArrayView<double> Out);
+
+	// Sample a grid of Size points, where point (X, Y) is at (Origin + (X, Y) * Spacing).
+	SQUIRREL_API void SampleFractalGrid2D(const FSquirrelFractalSettings& Settings, uint32 Seed,
+		const FVector2D& Origin, const FVector2D& Spacing, FIntPoint Size, TArrayView<double> Out);
+
+	// Sample a grid of Size points, where point (X, Y, Z) is at (Origin + (X, Y, Z) * Spacing).
+	SQUIRREL_API void SampleFractalGrid3D(const FSquirrelFractalSettings& Settings, uint32 Seed,
+		const FVector& Origin, const FVector& Spacing, FIntVector Size, TArrayView<double> Out);
+}
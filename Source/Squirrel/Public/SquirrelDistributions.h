@@ -0,0 +1,50 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The ziggurat tables, the rejection methods, and
+ *	the way noise is drawn for each sample determine
+ *	the output of existing seeds.
+ */
+
+/*
+ * Non-uniform distributions.
+ *
+ * Every sample consumes exactly one position, however many times it is rejected internally. The first value of a sample is
+ * the noise of its position; any further values it needs are hashed from the same position under derived seeds. So a
+ * sample can always be replayed from its position alone, and the batch functions generate the noise of each chunk of
+ * positions together in SIMD lanes, with output identical to calling the scalar function once per element.
+ *
+ * All math is done in double precision by functions of this plugin, rather than those of the platform's C library, so
+ * the results do not vary between platforms.
+ */
+namespace Squirrel
+{
+	// Normally distributed, generated by the ziggurat method (128 layers).
+	SQUIRREL_API [[nodiscard]] double NextNormal(FSquirrelState& State, double Mean = 0.0, double StdDev = 1.0);
+
+	// Exponentially distributed, generated by the ziggurat method (256 layers). Rate must be above 0.
+	SQUIRREL_API [[nodiscard]] double NextExponential(FSquirrelState& State, double Rate = 1.0);
+
+	// Poisson distributed. Uses multiplication of uniforms below a mean of 10, and Hoermann's PTRS above. Returns 0 if the
+	// mean is not above 0.
+	SQUIRREL_API [[nodiscard]] int32 NextPoisson(FSquirrelState& State, double Mean);
+
+	// Number of successes in Trials, each succeeding with Probability. Uses inversion when the expected number of successes
+	// (of the rarer outcome) is below 10, and Hoermann's BTRS above.
+	SQUIRREL_API [[nodiscard]] int32 NextBinomial(FSquirrelState& State, int32 Trials, double Probability);
+
+	// Triangular distribution over [Min, Max], peaking at Mode. Generated by inversion.
+	SQUIRREL_API [[nodiscard]] double NextTriangular(FSquirrelState& State, double Min, double Mode, double Max);
+
+	SQUIRREL_API void FillNormal(FSquirrelState& State, TArrayView<double> Out, double Mean = 0.0, double StdDev = 1.0);
+	SQUIRREL_API void FillExponential(FSquirrelState& State, TArrayView<double> Out, double Rate = 1.0);
+	SQUIRREL_API void FillPoisson(FSquirrelState& State, TArrayView<int32> Out, double Mean);
+	SQUIRREL_API void FillBinomial(FSquirrelState& State, TArrayView<int32> Out, int32 Trials, double Probability);
+	SQUIRREL_API void FillTriangular(FSquirrelState& State, TArrayView<double> Out, double Min, double Mode, double Max);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/*
+ * Seeded geometric random values.
+ *
+ * Every element consumes a fixed number of positions (see the PositionsPer* constants) so that the Nth element of a
+ * batch can be regenerated by jumping to (StartPosition + N * PositionsPer*) and calling the matching Next* function.
+ * The double versions are built from the same [0,1] mapping as NextReal, and batches of them match calling the Next*
+ * functions once per element. The float versions are evaluated four elements at a time in vector registers, and are not
+ * guaranteed to match the double versions beyond float precision.
+ */
+namespace Squirrel
+{
+	namespace Geometry
+	{
+		constexpr int32 PositionsPerUnitVector = 2;
+		constexpr int32 PositionsPerPointInBox = 3;
+		constexpr int32 PositionsPerPointInSphere = 3;
+		constexpr int32 PositionsPerPointInDisc = 2;
+		constexpr int32 PositionsPerRotator = 3;
+		constexpr int32 PositionsPerQuat = 3;
+	}
+
+	// A uniformly distributed direction on the unit sphere.
+	SQUIRREL_API [[nodiscard]] FVector NextUnitVector(FSquirrelState& State);
+
+	// A uniformly distributed point inside of Box.
+	SQUIRREL_API [[nodiscard]] FVector NextPointInBox(FSquirrelState& State, const FBox& Box);
+
+	// A uniformly distributed point inside of a sphere centered on the origin.
+	SQUIRREL_API [[nodiscard]] FVector NextPointInSphere(FSquirrelState& State, double Radius);
+
+	// A uniformly distributed point inside of a disc centered on the origin.
+	SQUIRREL_API [[nodiscard]] FVector2D NextPointInDisc(FSquirrelState& State, double Radius);
+
+	// A rotator with each axis in the range [0,360]. An axis is exactly 360 when its NextReal is exactly 1.
+	SQUIRREL_API [[nodiscard]] FRotator NextRotator(FSquirrelState& State);
+
+	// A uniformly distributed rotation.
+	SQUIRREL_API [[nodiscard]] FQuat NextQuat(FSquirrelState& State);
+
+	SQUIRREL_API void FillUnitVectors(FSquirrelState& State, TArrayView<FVector> Out);
+	SQUIRREL_API void FillUnitVectors(FSquirrelState& State, TArrayView<FVector3f> Out);
+
+	SQUIRREL_API void FillPointsInBox(FSquirrelState& State, const FBox& Box, TArrayView<FVector> Out);
+	SQUIRREL_API void FillPointsInBox(FSquirrelState& State, const FBox3f& Box, TArrayView<FVector3f> Out);
+
+	SQUIRREL_API void FillPointsInSphere(FSquirrelState& State, double Radius, TArrayView<FVector> Out);
+	SQUIRREL_API void FillPointsInSphere(FSquirrelState& State, float Radius, TArrayView<FVector3f> Out);
+
+	SQUIRREL_API void FillPointsInDisc(FSquirrelState& State, double Radius, TArrayView<FVector2D> Out);
+	SQUIRREL_API void FillPointsInDisc(FSquirrelState& State, float Radius, TArrayView<FVector2f> Out);
+
+	// Each axis in the range [0,360], like NextRotator.
+	SQUIRREL_API void FillRotators(FSquirrelState& State, TArrayView<FRotator> Out);
+	SQUIRREL_API void FillRotators(FSquirrelState& State, TArrayView<FRotator3f> Out);
+
+	SQUIRREL_API void FillQuats(FSquirrelState& State, TArrayView<FQuat> Out);
+	SQUIRREL_API void FillQuats(FSquirrelState& State, TArrayView<FQuat4f> Out);
+}
@@ -0,0 +1,49 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/**
+ * A rectangle of cells to sample 2D noise for. Cell (X, Y) samples the noise at (Origin + (X, Y) * Stride).
+ */
+struct FSquirrelGrid2D
+{
+	FIntPoint Origin = FIntPoint::ZeroValue;
+	FIntPoint Size = FIntPoint::ZeroValue;
+	FIntPoint Stride = FIntPoint(1, 1);
+	uint32 Seed = 0;
+
+	int32 Num() const { return Size.X * Size.Y; }
+};
+
+/**
+ * A box of cells to sample 3D noise for. Cell (X, Y, Z) samples the noise at (Origin + (X, Y, Z) * Stride).
+ */
+struct FSquirrelGrid3D
+{
+	FIntVector Origin = FIntVector::ZeroValue;
+	FIntVector Size = FIntVector::ZeroValue;
+	FIntVector Stride = FIntVector(1, 1, 1);
+	uint32 Seed = 0;
+
+	int32 Num() const { return Size.X * Size.Y * Size.Z; }
+};
+
+/*
+ * Bulk evaluation of the Get2d/Get3dNoise functions over grids of cells.
+ *
+ * Output is written in X-major order, i.e. Out[X + Y * Size.X + Z * Size.X * Size.Y], and must have exactly Grid.Num()
+ * elements. The grid is split into cache-sized tiles which are evaluated in parallel. Every cell is bit-identical to
+ * calling the matching single-sample function, regardless of how many threads take part.
+ */
+namespace Squirrel::Grid
+{
+	SQUIRREL_API void Fill2dNoiseUint(const FSquirrelGrid2D& Grid, TArrayView<uint32> Out);
+	SQUIRREL_API void Fill2dNoiseZeroToOne(const FSquirrelGrid2D& Grid, TArrayView<double> Out);
+	SQUIRREL_API void Fill2dNoiseNegOneToOne(const FSquirrelGrid2D& Grid, TArrayView<double> Out);
+
+	SQUIRREL_API void Fill3dNoiseUint(const FSquirrelGrid3D& Grid, TArrayView<uint32> Out);
+	SQUIRREL_API void Fill3dNoiseZeroToOne(const FSquirrelGrid3D& Grid, TArrayView<double> Out);
+	SQUIRREL_API void Fill3dNoiseNegOneToOne(const FSquirrelGrid3D& Grid, TArrayView<double> Out);
+}
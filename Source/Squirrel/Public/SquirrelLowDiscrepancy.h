@@ -0,0 +1,59 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The recurrence constants, direction numbers, and
+ *	scrambling here determine the output of existing seeds.
+ */
+
+/*
+ * Seeded low-discrepancy sequences in 1-4D. Their points cover [0,1)^D far more evenly than NextReal does, so estimates
+ * made from them (ambient occlusion rays, probe placement, query scoring) converge with several times fewer samples.
+ *
+ * Every sequence is randomly accessible. Point Index only depends on the sequence, the number of dimensions, Index and the
+ * seed. The stream functions use State.Position as the index and advance it by one per point, so a stream of points can be
+ * scrubbed and replayed like any other FSquirrelState. Each seed scrambles the sequence differently, with every scramble
+ * derived from SquirrelNoise5, and every scramble keeps the sequence low-discrepancy.
+ */
+namespace Squirrel::LowDiscrepancy
+{
+	enum class ESequence : uint8
+	{
+		// Roberts' R-sequence, which adds a power of the generalized golden ratio to each axis per point (the R2 sequence
+		// in 2D). The cheapest, and evenly spread at any count. Scrambled with a random toroidal shift.
+		Rd,
+
+		// Halton, in bases 2, 3, 5 and 7. Scrambled by nested random digit permutations.
+		Halton,
+
+		// Sobol, with the Joe-Kuo direction numbers. Most even at power-of-two counts. The index is shuffled and every axis
+		// is Owen-scrambled, as in Burley, "Practical Hash-based Owen Scrambling".
+		Sobol
+	};
+
+	SQUIRREL_API [[nodiscard]] double Sample1D(ESequence Sequence, uint32 Index, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] FVector2D Sample2D(ESequence Sequence, uint32 Index, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] FVector Sample3D(ESequence Sequence, uint32 Index, uint32 Seed);
+	SQUIRREL_API [[nodiscard]] FVector4 Sample4D(ESequence Sequence, uint32 Index, uint32 Seed);
+
+	// The point at State.Position, scrambled by the seed of the current context. Advances State by one.
+	SQUIRREL_API [[nodiscard]] double Next1D(FSquirrelState& State, ESequence Sequence);
+	SQUIRREL_API [[nodiscard]] FVector2D Next2D(FSquirrelState& State, ESequence Sequence);
+	SQUIRREL_API [[nodiscard]] FVector Next3D(FSquirrelState& State, ESequence Sequence);
+	SQUIRREL_API [[nodiscard]] FVector4 Next4D(FSquirrelState& State, ESequence Sequence);
+
+	/**
+	 * Fill an array with consecutive points, advancing State by the number of elements.
+	 * Output is identical to calling the matching Next function once per element, but large batches are spread across
+	 * worker threads.
+	 */
+	SQUIRREL_API void Fill(FSquirrelState& State, ESequence Sequence, TArrayView<double> Out);
+	SQUIRREL_API void Fill(FSquirrelState& State, ESequence Sequence, TArrayView<FVector2D> Out);
+	SQUIRREL_API void Fill(FSquirrelState& State, ESequence Sequence, TArrayView<FVector> Out);
+	SQUIRREL_API void Fill(FSquirrelState& State, ESequence Sequence, TArrayView<FVector4> Out);
+}
\ No newline at end of file
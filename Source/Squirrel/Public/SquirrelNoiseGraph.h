@@ -0,0 +1,201 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "SquirrelCoherentNoise.h"
+
+#include "SquirrelNoiseGraph.generated.h"
+
+UENUM(BlueprintType)
+enum class ESquirrelNoiseOp : uint8
+{
+	// Outputs Value.
+	Constant,
+
+	// White noise in [-1,1], constant across each cell of size 1/Frequency. Uses Fractal.Frequency.
+	Hash,
+
+	// A single octave of value or gradient noise. Uses Fractal.Basis and Fractal.Frequency.
+	Noise,
+
+	// Several octaves of noise. Uses all of Fractal.
+	Fractal,
+
+	// Outputs a position, offset from its own position by (InputA, InputB, InputC) * Value. Other nodes sample at this
+	// position by setting it as their PositionInput.
+	Warp,
+
+	// Linearly maps InputA from [InMin,InMax] to [OutMin,OutMax]. When InMin == InMax, outputs OutMin.
+	Remap,
+
+	// InputA + InputB
+	Add,
+
+	// InputA * InputB
+	Multiply,
+
+	// Min(InputA, InputB)
+	Min,
+
+	// Max(InputA, InputB)
+	Max,
+
+	// Lerp(InputA, InputB, InputC)
+	Blend
+};
+
+UENUM(BlueprintType)
+enum class ESquirrelNoiseGraphDimensions : uint8
+{
+	// Samples the X and Y of each position.
+	Two,
+
+	// Samples the X, Y and Z of each position.
+	Three
+};
+
+USTRUCT(BlueprintType)
+struct SQUIRREL_API FSquirrelNoiseGraphNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	ESquirrelNoiseOp Op = ESquirrelNoiseOp::Constant;
+
+	// Inputs are indices of earlier nodes in the graph.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	int32 InputA = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	int32 InputB = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	int32 InputC = INDEX_NONE;
+
+	// Index of an earlier Warp node to take the sampling position from. When unset, the graph's input position is used.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	int32 PositionInput = INDEX_NONE;
+
+	// Constant value, or warp strength.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	double Value = 0.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	FSquirrelFractalSettings Fractal;
+
+	// Added to the graph's seed for this node, so that identical noise nodes can differ.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	int32 SeedOffset = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	FVector2D InRange = FVector2D(-1.0, 1.0);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Node")
+	FVector2D OutRange = FVector2D(0.0, 1.0);
+};
+
+/**
+ * A single step of a compiled noise graph. Registers are per-sample arrays; the evaluator runs each instruction over a
+ * whole batch of samples before moving on to the next.
+ */
+struct FSquirrelNoiseInstruction
+{
+	ESquirrelNoiseOp Op = ESquirrelNoiseOp::Constant;
+
+	// Destination register. A position register for Warp, otherwise a scalar register.
+	uint16 Dest = 0;
+
+	// Scalar source registers.
+	uint16 A = 0;
+	uint16 B = 0;
+	uint16 C = 0;
+
+	// Position source register. Register 0 holds the input positions.
+	uint16 Position = 0;
+
+	uint32 SeedOffset = 0;
+
+	double Params[4] = {};
+
+	FSquirrelFractalSettings Fractal;
+};
+
+/**
+ * A noise graph flattened into a linear list of instructions, with registers reused once their values are no longer needed.
+ */
+class SQUIRREL_API FSquirrelNoiseProgram
+{
+public:
+	bool IsValid() const { return !Instructions.IsEmpty(); }
+
+	// Evaluate the program for each point. Batches of points are spread across worker threads.
+	void Evaluate(uint32 Seed, TConstArrayView<FVector> Points, TArrayView<double> Out) const;
+
+	// Evaluate the program for a batch of points on the calling thread.
+	void EvaluateBatch(uint32 Seed, const FVector* Points, int32 Num, double* Out) const;
+
+	// Hash of the compiled instructions. Programs that produce identical output have identical hashes.
+	uint32 GetHash() const { return Hash; }
+
+private:
+	friend class USquirrelNoiseGraph;
+
+	TArray<FSquirrelNoiseInstruction> Instructions;
+	uint32 Hash = 0;
+	ESquirrelNoiseGraphDimensions Dimensions = ESquirrelNoiseGraphDimensions::Two;
+	int32 NumScalarRegisters = 0;
+	int32 NumPositionRegisters = 1;
+	uint16 OutputRegister = 0;
+};
+
+/**
+ * A composable noise function, built from a list of nodes and compiled into a flat program for fast batch evaluation.
+ * All randomness comes from the SquirrelNoise5 functions, seeded by the seed passed to Evaluate.
+ */
+UCLASS(BlueprintType)
+class SQUIRREL_API USquirrelNoiseGraph : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Rebuild the compiled program from the nodes. Returns false, and clears the program, if the graph is invalid.
+	bool Compile(FText* OutError = nullptr);
+
+	const FSquirrelNoiseProgram& GetProgram() const { return *Program; }
+
+	// The compiled program is replaced, never modified, when the graph is recompiled, so it is safe to hold on to this
+	// reference while evaluating on other threads.
+	TSharedRef<const FSquirrelNoiseProgram, ESPMode::ThreadSafe> GetProgramRef() const { return Program; }
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|Noise Graph")
+	double Evaluate(const FVector& Point, int64 Seed) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|Noise Graph")
+	void EvaluateBatch(const TArray<FVector>& Points, int64 Seed, TArray<double>& Out) const;
+
+	// Evaluates the nodes directly, one point at a time, using the scalar noise functions. Slow, but useful to validate the
+	// compiled program against.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|Noise Graph")
+	double EvaluateReference(const FVector& Point, int64 Seed) const;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Noise Graph")
+	ESquirrelNoiseGraphDimensions Dimensions = ESquirrelNoiseGraphDimensions::Two;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Noise Graph")
+	TArray<FSquirrelNoiseGraphNode> Nodes;
+
+	// The node whose value is the output of the graph. When unset, the last node is used.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Noise Graph")
+	int32 OutputNode = INDEX_NONE;
+
+private:
+	int32 GetOutputNode() const;
+
+	TSharedRef<const FSquirrelNoiseProgram, ESPMode::ThreadSafe> Program = MakeShared<FSquirrelNoiseProgram, ESPMode::ThreadSafe>();
+};
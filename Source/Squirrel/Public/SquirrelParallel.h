@@ -0,0 +1,66 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+#include "Async/ParallelFor.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	How child streams are derived determines the
+ *	output of existing seeds.
+ */
+
+namespace Squirrel
+{
+	/**
+	 * Seeded ParallelFor. Each index is given its own child stream, Split(Base, Index), where Base is drawn from State, so the
+	 * output only depends on State and Num, and never on the number of workers or the order they run in. State is advanced
+	 * by one position, so that consecutive calls generate differently.
+	 *
+	 * The calling thread's context is bound on the workers while Body runs.
+	 *
+	 * @param Body Called as Body(int32 Index, FSquirrelState& IndexState)
+	 */
+	template <typename BodyType>
+	void ParallelForSeeded(const int32 Num, FSquirrelState& State, BodyType&& Body, const EParallelForFlags Flags = EParallelForFlags::None)
+	{
+		FSquirrelContext& Context = GetCurrentContext();
+		const FSquirrelState Base{ Next<int32>(State) };
+
+		ParallelFor(Num,
+			[&Context, &Base, &Body](const int32 Index)
+			{
+				FSquirrelContextScope Scope(Context);
+				FSquirrelState IndexState = Split(Base, Index);
+				Body(Index, IndexState);
+			}, Flags);
+	}
+
+	/**
+	 * Seeded ParallelFor over batches of indices, for bodies too small to be worth a stream each. The batch with index B
+	 * covers [B * BatchSize, Min((B + 1) * BatchSize, Num)) and is given the child stream Split(Base, B), so the output
+	 * depends on BatchSize, but still never on the number of workers or the order they run in.
+	 *
+	 * @param Body Called as Body(int32 Start, int32 End, FSquirrelState& BatchState)
+	 */
+	template <typename BodyType>
+	void ParallelForSeededBatched(const int32 Num, const int32 BatchSize, FSquirrelState& State, BodyType&& Body,
+		const EParallelForFlags Flags = EParallelForFlags::None)
+	{
+		check(BatchSize > 0);
+
+		FSquirrelContext& Context = GetCurrentContext();
+		const FSquirrelState Base{ Next<int32>(State) };
+
+		ParallelFor(FMath::DivideAndRoundUp(Num, BatchSize),
+			[&Context, &Base, &Body, Num, BatchSize](const int32 Batch)
+			{
+				FSquirrelContextScope Scope(Context);
+				FSquirrelState BatchState = Split(Base, Batch);
+				const int32 Start = Batch * BatchSize;
+				Body(Start, FMath::Min(Start + BatchSize, Num), BatchState);
+			}, Flags);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+#include "Components/ActorComponent.h"
+
+#include "SquirrelReplication.generated.h"
+
+/**
+ * Replicates the server world's seed and runtime position to clients, so that they can regenerate seeded outcomes locally
+ * instead of having the results replicated. Add it to an always-relevant actor, such as the game state.
+ *
+ * Clients receive the state when they join and whenever the server calls Synchronize, e.g. after changing the seed. The
+ * runtime position is not kept in sync as it advances; Squirrels that should generate identically on both sides should
+ * have their own states replicated. A replicated FSquirrelState property only sends how far it has advanced since it was
+ * last sent, so keeping a stream in sync costs a couple of bytes per change.
+ *
+ * When several worlds share a process, as in multi-player PIE, each client world isolates its context before applying the
+ * replicated state, so that it doesn't overwrite the server's.
+ */
+UCLASS(ClassGroup = "Squirrel", meta = (BlueprintSpawnableComponent))
+class SQUIRREL_API USquirrelSeedReplicationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USquirrelSeedReplicationComponent();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void BeginPlay() override;
+
+	// Capture the server world's current seed and runtime position, to be sent to clients.
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Squirrel")
+	void Synchronize();
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel")
+	const FSquirrelWorldState& GetReplicatedState() const { return WorldState; }
+
+protected:
+	UFUNCTION()
+	void OnRep_WorldState();
+
+	UPROPERTY(ReplicatedUsing = "OnRep_WorldState")
+	FSquirrelWorldState WorldState;
+};
\ No newline at end of file
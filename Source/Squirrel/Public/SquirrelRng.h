@@ -0,0 +1,167 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	Every function here must generate exactly what
+ *	its counterpart in Squirrel.h does, for the same
+ *	state and seed. Squirrel.Benchmark checks this.
+ */
+
+namespace Squirrel
+{
+	// A seed known at compile time. Generators using it can run in constant evaluation.
+	template <uint32 Seed>
+	struct TFixedSeed
+	{
+		static constexpr uint32 Get() { return Seed; }
+	};
+
+	// A seed read once, when the generator is created. By default, this is the seed of the calling thread's current context.
+	struct FCachedSeed
+	{
+		FCachedSeed()
+		  : Seed(GetGlobalSeed())
+		{
+		}
+
+		constexpr explicit FCachedSeed(const uint32 InSeed)
+		  : Seed(InSeed)
+		{
+		}
+
+		constexpr uint32 Get() const { return Seed; }
+
+	private:
+		uint32 Seed;
+	};
+
+	/**
+	 * A header-only generator for hot loops. Each function generates the same values as its counterpart in Squirrel.h, but
+	 * inline, without an exported call or a lookup of the current context per value. Draws made through it are not counted
+	 * by Squirrel.Stats.
+	 *
+	 * The generator works on a copy of the state, so write GetState() back once done:
+	 *
+	 *		TSquirrelRng Rng(State);
+	 *		for (FVector& Point : Points) { Point.Z = Rng.NextRealInRange(-1.0, 1.0); }
+	 *		State = Rng.GetState();
+	 *
+	 * With a TFixedSeed, everything is constexpr:
+	 *
+	 *		static_assert(TSquirrelRng<TFixedSeed<1337>>(FSquirrelState()).NextUint32() == Raw::SquirrelNoise5(0, 1337));
+	 */
+	template <typename SeedPolicy = FCachedSeed>
+	class TSquirrelRng
+	{
+	public:
+		constexpr explicit TSquirrelRng(const FSquirrelState& InState, const SeedPolicy& InSeed = SeedPolicy())
+		  : Position(InState.Position),
+			Seed(InSeed)
+		{
+		}
+
+		constexpr FSquirrelState GetState() const
+		{
+			FSquirrelState State;
+			State.Position = Position;
+			return State;
+		}
+
+		constexpr uint32 GetSeed() const { return Seed.Get(); }
+
+		constexpr uint32 NextUint32()
+		{
+			return Raw::SquirrelNoise5(Position++, Seed.Get());
+		}
+
+		// Same as Squirrel::Next<T>.
+		template <
+			typename T
+			UE_REQUIRES(TIsIntegral<T>::Value)
+		>
+		constexpr T Next()
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				return !!(NextUint32() % 2);
+			}
+			else if constexpr (sizeof(T) >= 4)
+			{
+				return static_cast<T>(NextUint32());
+			}
+			else
+			{
+				return static_cast<T>(NextUint32() % TNumericLimits<T>::Max());
+			}
+		}
+
+		// Same as Squirrel::NextInt32.
+		constexpr int32 NextInt32(const int32 Max)
+		{
+			if (Max <= 0)
+			{
+				return 0;
+			}
+
+			// Truncates toward zero, like FMath::TruncToInt.
+			const int32 Value = static_cast<int32>(NextReal() * static_cast<double>(Max));
+			return Value < Max - 1 ? Value : Max - 1;
+		}
+
+		// Same as Squirrel::NextInt32InRange.
+		constexpr int32 NextInt32InRange(const int32 Min, const int32 Max)
+		{
+			return Min + NextInt32((Max - Min) + 1);
+		}
+
+		// Same as Squirrel::NextReal.
+		constexpr double NextReal()
+		{
+			return Raw::ONE_OVER_MAX_UINT * static_cast<double>(NextUint32());
+		}
+
+		// Same as Squirrel::NextRealInRange.
+		constexpr double NextRealInRange(const double Min, const double Max)
+		{
+			return Min + (Max - Min) * NextReal();
+		}
+
+		// Same as Squirrel::RollChance, without validating the inputs.
+		constexpr bool RollChance(double& Roll, const double Chance, const double RollModifier)
+		{
+			Roll = NextRealInRange(0.0, 100.0 - RollModifier) + RollModifier;
+			return Roll >= Chance;
+		}
+
+		// Same as Squirrel::V2::Roll.
+		constexpr bool Roll(const V2::FChance Chance)
+		{
+			return Chance.Test(NextUint32());
+		}
+
+		// Same as Squirrel::RoundWithWeightByFraction.
+		constexpr int32 RoundWithWeightByFraction(const double Value)
+		{
+			// constexpr version of FMath::Floor
+			const int64 Int = static_cast<int64>(Value);
+			const double Whole = Value < Int ? Int - 1 : Int;
+			const double Remainder = Value - Whole;
+
+			if (Remainder <= 0.0)
+			{
+				return static_cast<int32>(Whole);
+			}
+
+			return static_cast<int32>(Whole + (Remainder >= NextReal()));
+		}
+
+	private:
+		int32 Position;
+		SeedPolicy Seed;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	Candidate placement and the phase order determine
+ *	the output of existing seeds.
+ */
+
+struct FSquirrelPoissonDiskSettings
+{
+	// No two points will be closer than this.
+	double Radius = 100.0;
+
+	// Number of candidate points tried per cell. More candidates produce denser, more evenly packed results.
+	int32 CandidatesPerCell = 8;
+
+	uint32 Seed = 0;
+};
+
+/*
+ * Deterministic Poisson-disk (blue noise) scattering.
+ *
+ * The plane is divided into cells of (Radius / sqrt(2)), so that each cell can hold at most one point. Every candidate of a
+ * cell is derived only from Get2dNoiseUint(CellX, CellY, Seed). Cells are filled in 9 global phases (by cell coordinate
+ * modulo 3), where the cells of one phase are far enough apart to be filled in parallel, and only test against points
+ * accepted by earlier phases. Because phases are global, any region produces exactly the same points as any other region
+ * overlapping it, regardless of generation order or thread count, so chunks can be generated independently.
+ */
+namespace Squirrel::Scatter
+{
+	/**
+	 * Density mask for scattering. Returns the probability, in [0,1], of a candidate at a location being kept.
+	 * Called from worker threads, and must return the same value for the same location every time.
+	 */
+	using FDensityMask = TFunctionRef<double(const FVector2D& Location)>;
+
+	// Receives a batch of points. Batches are delivered in a fixed order on the calling thread.
+	using FPointSink = TFunctionRef<void(TConstArrayView<FVector2D> Points)>;
+
+	SQUIRREL_API void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, FPointSink OnPoints);
+	SQUIRREL_API void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, FDensityMask Mask, FPointSink OnPoints);
+
+	// Convenience versions that append every point in Region to OutPoints.
+	SQUIRREL_API void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, TArray<FVector2D>& OutPoints);
+	SQUIRREL_API void PoissonDisk(const FSquirrelPoissonDiskSettings& Settings, const FBox2D& Region, FDensityMask Mask, TArray<FVector2D>& OutPoints);
+}
@@ -0,0 +1,75 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The order that positions are consumed in, and how
+ *	they are reduced into a range, determine the output
+ *	of existing seeds.
+ */
+
+namespace Squirrel
+{
+	namespace Impl
+	{
+		// Number of positions generated on the stack at a time while shuffling.
+		static constexpr int32 ShuffleChunkSize = 256;
+
+		// Multiply-shift reduction of raw noise into [0, Range). Biased by at most Range / 2^32, which keeps the number of
+		// positions a shuffle consumes fixed, where rejection would not.
+		constexpr int32 ReduceToRange(const uint32 Noise, const int32 Range)
+		{
+			return static_cast<int32>((static_cast<uint64>(Noise) * static_cast<uint32>(Range)) >> 32);
+		}
+	}
+
+	/**
+	 * Shuffle an array in place with a forward Fisher-Yates pass. For each index I, in order, except the last, one position is
+	 * consumed to pick an index J in [I, Num), and the elements at I and J are swapped. A shuffle therefore always consumes
+	 * exactly Max(Num - 1, 0) positions. The noise is generated in SIMD lanes, a chunk at a time.
+	 */
+	template <typename T>
+	void Shuffle(FSquirrelState& State, const TArrayView<T> Array)
+	{
+		SQUIRREL_TRACE_BATCH(Shuffle, Array.Num());
+		SQUIRREL_COUNT(ShuffledElements, Array.Num());
+
+		uint32 Noise[Impl::ShuffleChunkSize];
+
+		const int32 Draws = Array.Num() - 1;
+		for (int32 Offset = 0; Offset < Draws; Offset += Impl::ShuffleChunkSize)
+		{
+			const int32 Count = FMath::Min(Impl::ShuffleChunkSize, Draws - Offset);
+			Fill(State, MakeArrayView(Noise, Count));
+
+			for (int32 k = 0; k < Count; ++k)
+			{
+				const int32 I = Offset + k;
+				const int32 J = I + Impl::ReduceToRange(Noise[k], Array.Num() - I);
+				if (I != J)
+				{
+					Swap(Array[I], Array[J]);
+				}
+			}
+		}
+	}
+
+	template <typename T, typename AllocatorType>
+	void Shuffle(FSquirrelState& State, TArray<T, AllocatorType>& Array)
+	{
+		Shuffle(State, MakeArrayView(Array));
+	}
+
+	/**
+	 * Pick K unique indices in [0, N), in random order. Out is set to Min(K, N) elements, and exactly that many positions are
+	 * consumed. The result is the first K elements of shuffling the indices [0, N) with Shuffle.
+	 *
+	 * When K is much smaller than N, the shuffle is emulated with a map of the displaced indices, so only O(K) memory and time
+	 * are needed. This is an implementation detail; the result does not depend on it.
+	 */
+	SQUIRREL_API void SampleWithoutReplacement(FSquirrelState& State, int32 N, int32 K, TArray<int32>& Out);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "SquirrelStateLibrary.generated.h"
+
+/**
+ * Blueprint generation from a bare FSquirrelState, for when a USquirrel object per stream is more than is needed. A state
+ * can be stored in any struct or actor property, and generates exactly the same values as a USquirrel at the same position.
+ *
+ * The array functions produce a whole batch in a single call. Each matches calling its single-value function Count times.
+ * To run per-element logic with its own random stream, Split a state into an array of states and loop over that, so that
+ * each element's values don't depend on how much the others consumed.
+ *
+ * Generation uses the seed of the world's isolated context if it has one, otherwise the global seed.
+ */
+UCLASS()
+class SQUIRREL_API USquirrelStateLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Squirrel|State")
+	static FSquirrelState MakeSquirrelState(int32 Position);
+
+	// A state at a new position from the world's runtime stream, like that given to a USquirrel created during gameplay.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static FSquirrelState NewSquirrelState(const UObject* WorldContextObject);
+
+	UFUNCTION(BlueprintPure, Category = "Squirrel|State")
+	static int32 GetPosition(const FSquirrelState& State);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State")
+	static void Jump(UPARAM(ref) FSquirrelState& State, int32 NewPosition);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static int32 NextInt32(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Max);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static int32 NextInt32InRange(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Min, int32 Max);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static bool NextBool(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static double NextReal(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static double NextRealInRange(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, double Min, double Max);
+
+	// See USquirrel::RollChance.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static bool RollChance(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, double& Roll, double Chance, double RollModifier);
+
+	// See USquirrel::RoundWithWeightByFraction.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static int32 RoundWithWeightByFraction(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, double Value);
+
+	// Derive the state of an independent child stream, without advancing State.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State", meta = (WorldContext = "WorldContextObject"))
+	static FSquirrelState Split(const UObject* WorldContextObject, const FSquirrelState& State, int32 Index);
+
+	// Derive Count independent child streams, one per element of a loop, without advancing State.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void SplitArray(const UObject* WorldContextObject, const FSquirrelState& State, int32 Count, TArray<FSquirrelState>& OutStates);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextInt32Array(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, int32 Max, TArray<int32>& OutValues);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextInt32InRangeArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, int32 Min, int32 Max, TArray<int32>& OutValues);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextBoolArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, TArray<bool>& OutValues);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextRealArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, TArray<double>& OutValues);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextRealInRangeArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, double Min, double Max, TArray<double>& OutValues);
+
+	// Roll Count chances, as with RollChance. OutRolls and OutSuccesses are index-aligned.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void RollChanceArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, double Chance, double RollModifier,
+		TArray<double>& OutRolls, TArray<bool>& OutSuccesses);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextUnitVectorArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, TArray<FVector>& OutVectors);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextPointInBoxArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, const FBox& Box, TArray<FVector>& OutPoints);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextPointInSphereArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, double Radius, TArray<FVector>& OutPoints);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|State|Array", meta = (WorldContext = "WorldContextObject"))
+	static void NextRotatorArray(const UObject* WorldContextObject, UPARAM(ref) FSquirrelState& State, int32 Count, TArray<FRotator>& OutRotators);
+};
\ No newline at end of file
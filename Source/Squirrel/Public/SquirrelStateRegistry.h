@@ -0,0 +1,142 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+
+struct FSquirrelStateHandle
+{
+	int32 Index = INDEX_NONE;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	friend bool operator==(const FSquirrelStateHandle& A, const FSquirrelStateHandle& B) { return A.Index == B.Index; }
+};
+
+/**
+ * Owns the states of many streams in one contiguous array, and saves and restores all of them at once, for rollback
+ * netcode. Streams that take part are registered once, and generate from the state the registry hands out for them.
+ *
+ * Each saved frame is a full copy of the states in a ring buffer of NumFrames frames. Changes are tracked per block of
+ * StatesPerBlock states, so that saving only copies the blocks that changed since the frame being overwritten, and
+ * restoring only copies the blocks that changed since the frame being restored. A block is changed when a state in it is
+ * accessed through Edit.
+ *
+ * A reference returned by Edit may only be written until the next SaveFrame or RestoreFrame: later writes through it are
+ * not seen by incremental saves and restores, so streams must call Edit again each frame.
+ * Not thread-safe.
+ */
+class SQUIRREL_API FSquirrelStateRegistry
+{
+public:
+	// One cache line of states.
+	static constexpr int32 StatesPerBlock = 16;
+
+	struct FRange
+	{
+		int32 First = 0;
+		int32 Num = 0;
+	};
+
+	FSquirrelStateRegistry(int32 InCapacity, int32 InNumFrames);
+
+	UE_NONCOPYABLE(FSquirrelStateRegistry)
+
+	// Add a stream. Returns an invalid handle if the registry is full.
+	FSquirrelStateHandle Register(FSquirrelState InitialState = FSquirrelState());
+	void Unregister(FSquirrelStateHandle Handle);
+
+	const FSquirrelState& Get(const FSquirrelStateHandle Handle) const
+	{
+		check(Registered[Handle.Index]);
+		return States[Handle.Index];
+	}
+
+	// The state of a stream, to generate from. Marks the stream as changed in the current frame, so don't keep the reference
+	// past the next save or restore.
+	FSquirrelState& Edit(const FSquirrelStateHandle Handle)
+	{
+		check(Registered[Handle.Index]);
+		MarkBlock(CurrentChanges, Handle.Index / StatesPerBlock);
+		return States[Handle.Index];
+	}
+
+	/**
+	 * Save the states as of the end of Frame. Frames must be saved in increasing order, though frames may be skipped. To
+	 * save over a frame that was already saved, restore an earlier frame first.
+	 */
+	void SaveFrame(int32 Frame);
+
+	/**
+	 * Restore the states saved for Frame. Frames saved after it are discarded. Returns false if Frame is no longer in the
+	 * ring buffer, in which case nothing is changed.
+	 */
+	bool RestoreFrame(int32 Frame);
+
+	bool HasFrame(int32 Frame) const;
+	int32 GetLastSavedFrame() const { return LastSavedFrame; }
+
+	// The ranges of states that may have changed since the last save or restore, in increasing order.
+	void GetDirtyRanges(TArray<FRange>& OutRanges) const;
+
+	// Number of states copied by the last save or restore.
+	int32 GetLastCopyCount() const { return LastCopyCount; }
+
+	int32 Num() const { return NumRegistered; }
+	int32 GetCapacity() const { return States.Num(); }
+	int32 GetNumFrames() const { return Slots.Num(); }
+
+private:
+	struct FFrameSlot
+	{
+		// The frame saved in this slot, or INDEX_NONE.
+		int32 Frame = INDEX_NONE;
+
+		// The frame saved before it, whose changes it follows on from.
+		int32 PreviousFrame = INDEX_NONE;
+
+		// Blocks changed between the save before this frame and this frame's.
+		TArray<uint64> Changes;
+
+		// When the frame in this slot was discarded by a rollback, the contents match the frame rolled back to, except for
+		// the blocks in Stale.
+		int32 BaseFrame = INDEX_NONE;
+		TArray<uint64> Stale;
+	};
+
+	static void MarkBlock(TArray<uint64>& Blocks, const int32 Block)
+	{
+		Blocks[Block / 64] |= uint64(1) << (Block % 64);
+	}
+
+	FSquirrelState* GetSnapshot(const int32 SlotIndex) { return Snapshots.GetData() + static_cast<int64>(SlotIndex) * States.Num(); }
+	int32 GetSlotIndex(const int32 Frame) const { return Frame % Slots.Num(); }
+
+	// Add the changes of every frame saved after AfterFrame to Blocks. Returns false if some of those changes are no longer
+	// known, because the frames they were saved with have been overwritten or discarded.
+	bool AddChangesSince(int32 AfterFrame, TArray<uint64>& Blocks) const;
+
+	// Call Func(First, Num) for each run of consecutive states in the marked blocks.
+	template <typename FuncType>
+	void ForEachRange(const TArray<uint64>& Blocks, FuncType&& Func) const;
+
+	// Copy the states of the marked blocks, and return the number of states copied.
+	int32 CopyBlocks(const TArray<uint64>& Blocks, const FSquirrelState* From, FSquirrelState* To) const;
+
+	TArray<FSquirrelState> States;
+	TBitArray<> Registered;
+	TArray<int32> FreeIndices;
+	int32 NumRegistered = 0;
+
+	TArray<FSquirrelState> Snapshots;
+	TArray<FFrameSlot> Slots;
+
+	// Blocks changed since the last save or restore.
+	TArray<uint64> CurrentChanges;
+
+	// The blocks to copy in a save or restore. Kept to avoid allocating each frame.
+	TArray<uint64> BlocksToCopy;
+
+	int32 LastSavedFrame = INDEX_NONE;
+	int32 LastCopyCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include <atomic>
+
+/*
+ * Instrumentation of how many positions each API consumes, shown under "stat Squirrel" and as Insights counters, and of
+ * batch calls, traced on the "Squirrel" trace channel (-trace=cpu,squirrel) with their sizes.
+ *
+ * Counting is off until enabled with Squirrel.Stats, and then costs a relaxed atomic add per call. Define
+ * SQUIRREL_INSTRUMENTATION to 0 to compile all of it out. It is compiled out of shipping builds by default.
+ */
+#ifndef SQUIRREL_INSTRUMENTATION
+#define SQUIRREL_INSTRUMENTATION !UE_BUILD_SHIPPING
+#endif
+
+DECLARE_STATS_GROUP(TEXT("Squirrel"), STATGROUP_Squirrel, STATCAT_Advanced);
+
+class USquirrel;
+
+namespace Squirrel::Stats
+{
+	class FObjectDrawScope;
+}
+
+#if SQUIRREL_INSTRUMENTATION
+
+UE_TRACE_CHANNEL_EXTERN(SquirrelChannel, SQUIRREL_API)
+
+namespace Squirrel::Stats
+{
+	enum class ECounter : uint8
+	{
+		// Positions consumed one at a time, through Next, NextReal, and everything built on them.
+		Next,
+		// Positions consumed in batches, through Fill and the batch functions built on it.
+		Fill,
+		// Positions handed out to Squirrels created at runtime.
+		NewPosition,
+		DistributionSamples,
+		WeightedSamples,
+		ShuffledElements,
+		NoiseSamples,
+		CellularSamples,
+		GridCells,
+		ScatteredPoints,
+		LowDiscrepancyPoints,
+		Num
+	};
+
+	// Set by Squirrel.Stats.
+	extern SQUIRREL_API bool GEnabled;
+
+	// Set by Squirrel.Stats.PerObject.
+	extern SQUIRREL_API bool GPerObjectEnabled;
+
+	extern SQUIRREL_API std::atomic<uint64> GCounters[static_cast<int32>(ECounter::Num)];
+
+	FORCEINLINE void Count(const ECounter Counter, const int64 Amount)
+	{
+		if (GEnabled)
+		{
+			GCounters[static_cast<int32>(Counter)].fetch_add(Amount, std::memory_order_relaxed);
+		}
+	}
+
+	// Publish the counts of the last frame to the stats system and Insights, and reset them. Called once per frame.
+	void Publish();
+
+	// Adds the positions a USquirrel consumes while in scope to its draw total, when Squirrel.Stats.PerObject is enabled.
+	class SQUIRREL_API FObjectDrawScope
+	{
+	public:
+		explicit FObjectDrawScope(USquirrel& InObject);
+		~FObjectDrawScope();
+
+		UE_NONCOPYABLE(FObjectDrawScope)
+
+	private:
+		USquirrel* Object;
+		int32 StartPosition;
+	};
+}
+
+#define SQUIRREL_COUNT(Counter, Amount) Squirrel::Stats::Count(Squirrel::Stats::ECounter::Counter, Amount)
+
+// Trace a batch call, with the number of elements in its name.
+#define SQUIRREL_TRACE_BATCH(Name, Num) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL( \
+		UE_TRACE_CHANNELEXPR_IS_ENABLED(SquirrelChannel) ? *FString::Printf(TEXT("Squirrel::%s (%d)"), TEXT(#Name), static_cast<int32>(Num)) : TEXT(#Name), \
+		SquirrelChannel)
+
+#define SQUIRREL_TRACK_OBJECT_DRAWS(Object) Squirrel::Stats::FObjectDrawScope PREPROCESSOR_JOIN(SquirrelObjectDrawScope, __LINE__)(Object)
+
+#else
+
+#define SQUIRREL_COUNT(Counter, Amount)
+#define SQUIRREL_TRACE_BATCH(Name, Num)
+#define SQUIRREL_TRACK_OBJECT_DRAWS(Object)
+
+#endif
\ No newline at end of file
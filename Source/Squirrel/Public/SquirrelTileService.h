@@ -0,0 +1,181 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/LruCache.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
+#include "SquirrelCoherentNoise.h"
+
+class FSquirrelNoiseProgram;
+class USquirrelNoiseGraph;
+
+/**
+ * Describes what a tile contains. Tiles are square grids of TileSize samples per side, spaced SampleSpacing apart in world
+ * units, filled with either the noise graph, or if none is set, the fractal.
+ */
+struct SQUIRREL_API FSquirrelTileConfig
+{
+	int32 TileSize = 64;
+
+	double SampleSpacing = 1.0;
+
+	FSquirrelFractalSettings Fractal;
+
+	const USquirrelNoiseGraph* Graph = nullptr;
+
+	uint32 GetHash() const;
+};
+
+/**
+ * Identifies a tile by everything that determines its contents. The config hash only speeds up lookups: keys are compared
+ * field by field, so configs whose hashes collide never share tiles.
+ */
+struct SQUIRREL_API FSquirrelTileKey
+{
+	FSquirrelTileKey() = default;
+	FSquirrelTileKey(const FSquirrelTileConfig& Config, uint32 InSeed, FIntPoint InCoord);
+
+	uint32 Seed = 0;
+	FIntPoint Coord = FIntPoint::ZeroValue;
+	int32 TileSize = 0;
+	double SampleSpacing = 0.0;
+
+	// Only used when there is no program.
+	FSquirrelFractalSettings Fractal;
+
+	// The compiled program of the graph. Recompiling a graph replaces its program, so tiles of the old one are never reused.
+	TSharedPtr<const FSquirrelNoiseProgram, ESPMode::ThreadSafe> Program;
+
+	uint32 ConfigHash = 0;
+
+	bool operator==(const FSquirrelTileKey& Other) const
+	{
+		return Seed == Other.Seed && Coord == Other.Coord && TileSize == Other.TileSize &&
+			SampleSpacing == Other.SampleSpacing && Program == Other.Program && (Program || Fractal == Other.Fractal);
+	}
+
+	friend uint32 GetTypeHash(const FSquirrelTileKey& Key)
+	{
+		return HashCombineFast(HashCombineFast(Key.Seed, GetTypeHash(Key.Coord)), Key.ConfigHash);
+	}
+};
+
+/**
+ * A generated tile of noise. Immutable once generated, and safe to read from any thread.
+ */
+struct FSquirrelNoiseTile
+{
+	FSquirrelTileKey Key;
+	int32 TileSize = 0;
+
+	// Samples in X-major order.
+	TArray<double> Values;
+
+	double GetValue(const int32 X, const int32 Y) const { return Values[X + Y * TileSize]; }
+
+	SIZE_T GetAllocatedSize() const { return sizeof(FSquirrelNoiseTile) + Values.GetAllocatedSize(); }
+};
+
+using FSquirrelNoiseTilePtr = TSharedPtr<const FSquirrelNoiseTile, ESPMode::ThreadSafe>;
+
+DECLARE_DELEGATE_OneParam(FOnSquirrelTileReady, FSquirrelNoiseTilePtr /* Tile */);
+
+struct FSquirrelTileServiceStats
+{
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+	uint64 Evictions = 0;
+	uint64 Cancellations = 0;
+	uint64 Generated = 0;
+	SIZE_T CachedBytes = 0;
+	int32 CachedTiles = 0;
+	int32 PendingTiles = 0;
+};
+
+/**
+ * Generates noise tiles on worker threads, and keeps them in a memory-bounded LRU cache.
+ *
+ * Pending tiles are generated nearest-first relative to the focus point, which is re-evaluated each time a worker picks up
+ * its next tile. Requests for the same tile are merged. Completion delegates are always called on the game thread.
+ */
+class SQUIRREL_API FSquirrelTileService
+{
+public:
+	explicit FSquirrelTileService(SIZE_T InMaxCacheBytes);
+	~FSquirrelTileService();
+
+	UE_NONCOPYABLE(FSquirrelTileService)
+
+	// Get a tile only if it is already cached.
+	FSquirrelNoiseTilePtr FindTile(const FSquirrelTileConfig& Config, uint32 Seed, FIntPoint Coord);
+
+	/**
+	 * Request a tile. If the tile is cached, OnReady is called immediately. Otherwise, it is called on the game thread
+	 * once the tile has been generated.
+	 * @return A handle that can be used to cancel the request, or 0 if OnReady has already been called.
+	 */
+	uint64 RequestTile(const FSquirrelTileConfig& Config, uint32 Seed, FIntPoint Coord, FOnSquirrelTileReady OnReady);
+
+	// Cancel a request. Its delegate will not be called. The tile is dropped if nothing else has requested it.
+	void CancelRequest(uint64 Handle);
+
+	/**
+	 * Move the point that tiles are prioritized around. Requests for tiles whose centers are further than CancelDistance
+	 * from the focus, and that have not started generating, are cancelled.
+	 */
+	void SetFocus(const FVector2D& WorldPosition, double CancelDistance = TNumericLimits<double>::Max());
+
+	void SetMaxCacheBytes(SIZE_T InMaxCacheBytes);
+
+	// Drop every cached tile.
+	void EmptyCache();
+
+	FSquirrelTileServiceStats GetStats() const;
+
+private:
+	struct FJob;
+
+	bool Tick(float DeltaTime);
+
+	void LaunchWorkers();
+	void WorkerLoop();
+	TSharedPtr<FJob> TakeNextJob();
+
+	// Must be called with Lock held.
+	void EvictToBudget();
+
+	// Must be called with Lock held.
+	void CancelJob(TSharedRef<FJob> Job);
+
+	static void Generate(FJob& Job);
+
+	mutable FCriticalSection Lock;
+
+	TLruCache<FSquirrelTileKey, FSquirrelNoiseTilePtr> Cache;
+	SIZE_T CachedBytes = 0;
+	SIZE_T MaxCacheBytes = 0;
+
+	// Tiles that have been requested but not generated yet.
+	TMap<FSquirrelTileKey, TSharedRef<FJob>> Jobs;
+
+	// Jobs that have not been picked up by a worker.
+	TArray<TSharedRef<FJob>> Pending;
+
+	// Jobs that have finished generating, waiting for their delegates to be called on the game thread.
+	TArray<TSharedRef<FJob>> Completed;
+
+	TMap<uint64, FSquirrelTileKey> RequestKeys;
+	uint64 NextRequestHandle = 1;
+
+	FVector2D Focus = FVector2D::ZeroVector;
+
+	TArray<UE::Tasks::FTask> Workers;
+	int32 ActiveWorkers = 0;
+	int32 MaxWorkers = 1;
+	bool bShuttingDown = false;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	FSquirrelTileServiceStats Stats;
+};
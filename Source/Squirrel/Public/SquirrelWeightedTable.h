@@ -0,0 +1,93 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "SquirrelWeightedTable.generated.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	The construction of the alias table and the way
+ *	samples are drawn from it determine the output of
+ *	existing seeds.
+ */
+
+/**
+ * A table of weighted indices that can be sampled in constant time, using Vose's alias method.
+ *
+ * The alias table is built once from the weights, and is rebuilt in a single O(n) pass on the next sample after any weights
+ * change, so a batch of changes only costs one rebuild. Every sample consumes exactly two positions: one selects a column,
+ * the other chooses between the column and its alias.
+ */
+USTRUCT(BlueprintType)
+struct SQUIRREL_API FSquirrelWeightedTable
+{
+	GENERATED_BODY()
+
+	static constexpr int32 PositionsPerSample = 2;
+
+	FSquirrelWeightedTable() = default;
+	explicit FSquirrelWeightedTable(TArray<double> InWeights);
+
+	int32 Num() const { return Weights.Num(); }
+	double GetWeight(const int32 Index) const { return Weights[Index]; }
+	TConstArrayView<double> GetWeights() const { return Weights; }
+
+	// Negative weights are treated as 0.
+	void SetWeight(int32 Index, double Weight);
+	void SetWeights(TArray<double> InWeights);
+	int32 Add(double Weight);
+
+	// Rebuild the alias table, if any weights have changed. Call this before sampling a table from several threads.
+	void Build();
+	bool IsBuilt() const { return bBuilt; }
+
+	// Pick an index, with a likelihood proportional to its weight. Returns INDEX_NONE if no weight is above 0.
+	int32 Sample(FSquirrelState& State);
+
+	// Pick an index from a table that is already built.
+	int32 Sample(FSquirrelState& State) const;
+
+	// Pick an index for each element of Out. Output is identical to calling Sample once per element.
+	void Sample(FSquirrelState& State, TArrayView<int32> Out);
+	void Sample(FSquirrelState& State, TArrayView<int32> Out) const;
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Weighted Table")
+	TArray<double> Weights;
+
+private:
+	// For each column, the chance, out of 2^32, of keeping the column rather than taking its alias.
+	TArray<uint32> Thresholds;
+
+	TArray<int32> Aliases;
+
+	bool bBuilt = false;
+};
+
+UCLASS()
+class SQUIRREL_API USquirrelWeightedTableLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Squirrel|Weighted Table")
+	static FSquirrelWeightedTable MakeWeightedTable(const TArray<double>& Weights);
+
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|Weighted Table")
+	static void SetWeight(UPARAM(ref) FSquirrelWeightedTable& Table, int32 Index, double Weight);
+
+	UFUNCTION(BlueprintPure, Category = "Squirrel|Weighted Table")
+	static int32 GetNumWeights(const FSquirrelWeightedTable& Table);
+
+	// Pick an index from the table, with a likelihood proportional to its weight. Returns -1 if no weight is above 0.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|Weighted Table")
+	static int32 NextWeightedIndex(USquirrel* Squirrel, UPARAM(ref) FSquirrelWeightedTable& Table);
+
+	// Pick Count indices from the table, with replacement.
+	UFUNCTION(BlueprintCallable, Category = "Squirrel|Weighted Table")
+	static void NextWeightedIndices(USquirrel* Squirrel, UPARAM(ref) FSquirrelWeightedTable& Table, int32 Count, TArray<int32>& OutIndices);
+};
\ No newline at end of file
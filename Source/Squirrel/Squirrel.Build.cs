@@ -11,15 +11,15 @@ public class Squirrel : ModuleRules
         PublicDependencyModuleNames.AddRange(
             new []
             {
-                "Core"
+                "Core",
+                "Engine"
             }
         );
 
         PrivateDependencyModuleNames.AddRange(
             new []
             {
-                "CoreUObject",
-                "Engine"
+                "CoreUObject"
             }
         );
     }
@@ -0,0 +1,23 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "Commandlets/SquirrelBenchmarkCommandlet.h"
+#include "SquirrelBenchmark.h"
+
+USquirrelBenchmarkCommandlet::USquirrelBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 USquirrelBenchmarkCommandlet::Main(const FString& Params)
+{
+	Squirrel::Benchmark::FOptions Options;
+	FParse::Value(*Params, TEXT("Iterations="), Options.Iterations);
+	FParse::Value(*Params, TEXT("Threads="), Options.MaxThreads);
+	Options.bVerifyOnly = FParse::Param(*Params, TEXT("VerifyOnly"));
+
+	return Squirrel::Benchmark::Run(Options) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "SquirrelBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the Squirrel benchmarks and golden-output checks headless, for CI.
+ * Usage: UnrealEditor-Cmd <Project> -run=SquirrelBenchmark [-Iterations=N] [-Threads=N] [-VerifyOnly]
+ * Returns a non-zero exit code if any check failed.
+ */
+UCLASS()
+class USquirrelBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USquirrelBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
\ No newline at end of file
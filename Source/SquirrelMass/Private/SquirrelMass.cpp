@@ -0,0 +1,127 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "SquirrelMass.h"
+
+/*
+ *					WARNING:
+ *	READ BEFORE MAKING ANY CHANGES THIS FILE:
+ *	How salts derive seeds, and how raw noise is mapped
+ *	to each type, determine the output of existing seeds.
+ */
+
+namespace Squirrel::Mass
+{
+	// Number of streams gathered on the stack at a time.
+	static constexpr int32 ChunkSize = 256;
+
+	// Draw the next raw value of every stream, and pass each chunk of values to Map(Offset, Noise, Num).
+	template <typename MapType>
+	static void Draw(const TArrayView<FSquirrelFragment> Streams, MapType&& Map)
+	{
+		const uint32 GlobalSeed = GetGlobalSeed();
+
+		int32 Positions[ChunkSize];
+		uint32 Seeds[ChunkSize];
+		uint32 Noise[ChunkSize];
+
+		for (int32 Offset = 0; Offset < Streams.Num(); Offset += ChunkSize)
+		{
+			const int32 Num = FMath::Min(ChunkSize, Streams.Num() - Offset);
+			FSquirrelFragment* Chunk = Streams.GetData() + Offset;
+
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Positions[i] = Chunk[i].State.Position;
+				Seeds[i] = GetSeed(Chunk[i], GlobalSeed);
+			}
+
+			NextEach(MakeArrayView(Positions, Num), MakeArrayView(Seeds, Num), MakeArrayView(Noise, Num));
+
+			for (int32 i = 0; i < Num; ++i)
+			{
+				Chunk[i].State.Position = Positions[i];
+			}
+
+			Map(Offset, Noise, Num);
+		}
+	}
+
+	template <typename T, typename ConvertType>
+	static void DrawConverted(const TArrayView<FSquirrelFragment> Streams, const TArrayView<T> Out, ConvertType&& Convert)
+	{
+		check(Out.Num() == Streams.Num());
+
+		Draw(Streams,
+			[&Out, &Convert](const int32 Offset, const uint32* Noise, const int32 Num)
+			{
+				T* Dest = Out.GetData() + Offset;
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Dest[i] = Convert(Noise[i]);
+				}
+			});
+	}
+
+	uint32 GetSeed(const FSquirrelFragment& Stream, const uint32 GlobalSeed)
+	{
+		return Stream.Salt != 0 ? HashCombine(static_cast<int32>(Stream.Salt), static_cast<int32>(GlobalSeed)) : GlobalSeed;
+	}
+
+	void InitializeStreams(const TArrayView<FSquirrelFragment> Streams, const FSquirrelState& Parent, const int32 FirstIndex)
+	{
+		for (int32 i = 0; i < Streams.Num(); ++i)
+		{
+			Streams[i].State = Split(Parent, FirstIndex + i);
+		}
+	}
+
+	void NextUint32(const TArrayView<FSquirrelFragment> Streams, const TArrayView<uint32> Out)
+	{
+		DrawConverted(Streams, Out, [](const uint32 Noise) { return Noise; });
+	}
+
+	void NextBool(const TArrayView<FSquirrelFragment> Streams, const TArrayView<bool> Out)
+	{
+		DrawConverted(Streams, Out, [](const uint32 Noise) { return !!(Noise % 2); });
+	}
+
+	void NextReal(const TArrayView<FSquirrelFragment> Streams, const TArrayView<double> Out)
+	{
+		DrawConverted(Streams, Out, [](const uint32 Noise) { return Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise); });
+	}
+
+	void NextReal(const TArrayView<FSquirrelFragment> Streams, const TArrayView<float> Out)
+	{
+		DrawConverted(Streams, Out, [](const uint32 Noise) { return static_cast<float>(Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise)); });
+	}
+
+	void NextRealInRange(const TArrayView<FSquirrelFragment> Streams, const double Min, const double Max, const TArrayView<double> Out)
+	{
+		DrawConverted(Streams, Out,
+			[Min, Max](const uint32 Noise) { return Min + (Max - Min) * (Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise)); });
+	}
+
+	void NextRealInRange(const TArrayView<FSquirrelFragment> Streams, const float Min, const float Max, const TArrayView<float> Out)
+	{
+		DrawConverted(Streams, Out,
+			[Min, Max](const uint32 Noise) { return Min + (Max - Min) * static_cast<float>(Raw::ONE_OVER_MAX_UINT * static_cast<double>(Noise)); });
+	}
+
+	void NextInt32InRange(const TArrayView<FSquirrelFragment> Streams, const int32 Min, const int32 Max, const TArrayView<int32> Out)
+	{
+		if (Max < Min)
+		{
+			DrawConverted(Streams, Out, [Min](uint32) { return Min; });
+			return;
+		}
+
+		// Multiply-shift, as V2's Fast mode. Wraps to 0 when the range covers all of int32.
+		const uint32 Range = static_cast<uint32>(Max) - static_cast<uint32>(Min) + 1;
+		DrawConverted(Streams, Out,
+			[Min, Range](const uint32 Noise)
+			{
+				const uint32 Offset = Range != 0 ? static_cast<uint32>((static_cast<uint64>(Noise) * Range) >> 32) : Noise;
+				return static_cast<int32>(static_cast<uint32>(Min) + Offset);
+			});
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "SquirrelMassFragments.h"
+#include "MassExecutionContext.h"
+
+/*
+ * Draws for every entity of a chunk at once. Each entity's stream advances by exactly one position per call, and its
+ * values only depend on its own fragment and the global seed, so they are the same however entities are laid out in
+ * chunks and whichever thread processes them. Streams with no salt generate exactly what Squirrel::Next<uint32>,
+ * Squirrel::NextReal, and Squirrel::V2::NextInt32InRange (in Fast mode) would for the same state.
+ *
+ * The global seed is read from the calling thread's current context. Processors that generate from an isolated context
+ * should open a FSquirrelContextScope in their chunk lambda.
+ */
+namespace Squirrel::Mass
+{
+	// The fragments of the chunk being executed.
+	inline TArrayView<FSquirrelFragment> GetStreams(FMassExecutionContext& Context)
+	{
+		return Context.GetMutableFragmentView<FSquirrelFragment>();
+	}
+
+	// The seed a fragment's stream is generated under.
+	SQUIRRELMASS_API [[nodiscard]] uint32 GetSeed(const FSquirrelFragment& Stream, uint32 GlobalSeed);
+
+	// Give each stream an independent position, Split from Parent by FirstIndex + its index. Use an index that is stable
+	// across runs, such as the spawn order, to give entities the same streams every time.
+	SQUIRRELMASS_API void InitializeStreams(TArrayView<FSquirrelFragment> Streams, const FSquirrelState& Parent, int32 FirstIndex);
+
+	SQUIRRELMASS_API void NextUint32(TArrayView<FSquirrelFragment> Streams, TArrayView<uint32> Out);
+	SQUIRRELMASS_API void NextBool(TArrayView<FSquirrelFragment> Streams, TArrayView<bool> Out);
+
+	// Values in the range [0,1].
+	SQUIRRELMASS_API void NextReal(TArrayView<FSquirrelFragment> Streams, TArrayView<double> Out);
+	SQUIRRELMASS_API void NextReal(TArrayView<FSquirrelFragment> Streams, TArrayView<float> Out);
+
+	SQUIRRELMASS_API void NextRealInRange(TArrayView<FSquirrelFragment> Streams, double Min, double Max, TArrayView<double> Out);
+	SQUIRRELMASS_API void NextRealInRange(TArrayView<FSquirrelFragment> Streams, float Min, float Max, TArrayView<float> Out);
+
+	// Values in [Min, Max]. Returns Min if Max is less than Min.
+	SQUIRRELMASS_API void NextInt32InRange(TArrayView<FSquirrelFragment> Streams, int32 Min, int32 Max, TArrayView<int32> Out);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Squirrel.h"
+#include "MassEntityTypes.h"
+
+#include "SquirrelMassFragments.generated.h"
+
+/**
+ * A random stream owned by a Mass entity, at 8 bytes per entity instead of a USquirrel object each.
+ */
+USTRUCT()
+struct SQUIRRELMASS_API FSquirrelFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Squirrel")
+	FSquirrelState State;
+
+	// When not 0, the stream is generated under a seed derived from this and the global seed, so that entities that share a
+	// position can still generate differently, e.g. one salt per agent type.
+	UPROPERTY(EditAnywhere, Category = "Squirrel")
+	uint32 Salt = 0;
+};
\ No newline at end of file
@@ -0,0 +1,28 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class SquirrelMass : ModuleRules
+{
+    public SquirrelMass(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(
+            new []
+            {
+                "Core",
+                "MassEntity",
+                "Squirrel"
+            }
+        );
+
+        PrivateDependencyModuleNames.AddRange(
+            new []
+            {
+                "CoreUObject",
+                "Engine"
+            }
+        );
+    }
+}
\ No newline at end of file